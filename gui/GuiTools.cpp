@@ -6,7 +6,7 @@
 
 namespace GUI {
 	namespace detail {
-		void coloredTextFormatImpl(const std::string &fmt, std::span<const WordColor> args) {
+		void coloredTextFormatImpl(std::string_view fmt, std::span<const WordColor> args) {
 			size_t argIndex = 0;
 			size_t pos      = 0;
 
@@ -16,20 +16,19 @@ namespace GUI {
 					if (argIndex < args.size()) {
 						const auto &wc = args[argIndex++];
 						ImGui::PushStyleColor(ImGuiCol_Text, ImGui::ColorConvertFloat4ToU32(wc.color));
-						ImGui::TextUnformatted(wc.text.c_str());
+						ImGui::TextUnformatted(wc.text.data(), wc.text.data() + wc.text.size());
 						ImGui::PopStyleColor();
 						ImGui::SameLine(0.0f, 0.0f);
 					}
 					pos += 2;
 				} else {
-					// Collect plain text until next {}
-					size_t      next  = fmt.find("{}", pos);
-					std::string plain = fmt.substr(pos, next - pos);
-					if (!plain.empty()) {
-						ImGui::TextUnformatted(plain.c_str());
+					// Plain text until next {}, drawn straight from fmt (TextUnformatted takes an end pointer, so no copy is needed)
+					size_t next = std::min(fmt.find("{}", pos), fmt.size());
+					if (next > pos) {
+						ImGui::TextUnformatted(fmt.data() + pos, fmt.data() + next);
 						ImGui::SameLine(0.0f, 0.0f);
 					}
-					pos = (next == std::string::npos) ? fmt.size() : next;
+					pos = next;
 				}
 			}
 
@@ -38,6 +37,17 @@ namespace GUI {
 		}
 	} // namespace detail
 
+	Memory::FrameArena &frameArena() {
+		thread_local int lastFrame = -1;
+
+		Memory::FrameArena &arena = Memory::frameArena();
+		if (const int frame = ImGui::GetFrameCount(); frame != lastFrame) {
+			lastFrame = frame;
+			arena.Reset();
+		}
+		return arena;
+	}
+
 	namespace Colors {
 		const ImVec4 White          = {1, 1, 1, 1};
 		const ImVec4 Red            = {1, 0, 0, 1};
@@ -65,7 +75,7 @@ namespace GUI {
 	} // namespace Colors
 
 	void open_link(const char *url) {
-		std::wstring wide_url = StringUtils::ToWideString(url);
+		std::wstring wide_url = Format::ToWideString(url);
 		ShellExecute(NULL, L"open", wide_url.c_str(), NULL, NULL, SW_SHOWNORMAL);
 	}
 
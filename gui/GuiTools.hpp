@@ -1,7 +1,14 @@
 #pragma once
 #include "pch.h"
+#include "../util/Utils.hpp"
 #include <span>
 
+namespace GUI {
+	// The calling thread's Memory::FrameArena, reset on the first call of each ImGui frame. Use it for temporaries in render code
+	// instead of resetting the arena by hand, so widgets and the code around them agree on when the frame starts
+	Memory::FrameArena &frameArena();
+} // namespace GUI
+
 #if IMGUI_VERSION_NUM < 19000
 static float CalcMaxPopupHeightFromItemCount(int items_count) {
 	ImGuiContext &g = *GImGui;
@@ -46,12 +53,12 @@ namespace ImGui {
 		int  matched_items = 0;
 		bool value_changed = false;
 
-		std::string search_input = input_buffer;
-		std::transform(
-		    search_input.begin(), search_input.end(), search_input.begin(), [](unsigned char c) { return (unsigned char)std::tolower(c); });
+		// per-frame temporaries come from the frame arena, so filtering doesn't hit the heap every frame the popup is open
+		Memory::FrameArena &arena        = GUI::frameArena();
+		std::pmr::string    search_input = Format::ToLower(input_buffer, &arena);
 
 		// Store keys in a vector for consistent ordering
-		std::vector<K> keys;
+		std::pmr::vector<K> keys{&arena};
 		keys.reserve(items_map.size());
 		for (const auto &pair : items_map)
 			keys.push_back(pair.first);
@@ -61,18 +68,18 @@ namespace ImGui {
 			return strcmp(get_display_text(items_map.at(a)), get_display_text(items_map.at(b))) < 0;
 		});
 
+		std::pmr::string item_text_lower{&arena};
 		for (const K &key : keys) {
 			const V    &item      = items_map.at(key);
 			const char *item_text = get_display_text(item);
 
 			// Filtering
-			std::string item_text_lower = item_text;
-			std::transform(item_text_lower.begin(), item_text_lower.end(), item_text_lower.begin(), [](unsigned char c) {
-				return (unsigned char)std::tolower(c);
-			});
-
-			if (!search_input.empty() && item_text_lower.find(search_input) == std::string::npos)
-				continue;
+			if (!search_input.empty()) {
+				item_text_lower.assign(item_text);
+				Format::ToLowerInline(item_text_lower);
+				if (item_text_lower.find(search_input) == std::pmr::string::npos)
+					continue;
+			}
 
 			matched_items++;
 			PushID((void *)(intptr_t)key);
@@ -110,11 +117,11 @@ namespace GUI {
 	};
 
 	namespace detail {
-		void coloredTextFormatImpl(const std::string &fmt, std::span<const WordColor> args);
+		void coloredTextFormatImpl(std::string_view fmt, std::span<const WordColor> args);
 	}
 
 	template <typename... Args>
-	void ColoredTextFormat(const std::string &fmt, Args &&...args) {
+	void ColoredTextFormat(std::string_view fmt, Args &&...args) {
 		std::array<WordColor, sizeof...(Args)> arr{std::forward<Args>(args)...};
 		detail::coloredTextFormatImpl(fmt, arr);
 	}
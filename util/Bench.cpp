@@ -0,0 +1,653 @@
+#include "pch.h"
+#include "Bench.hpp"
+#include "Utils.hpp"
+#include <new>
+#include <random>
+
+namespace {
+	// matches the "entries" file written by addUtilsSuite, for the typed JSON case
+	struct BenchEntry {
+		std::string id;
+		std::string name;
+		int         value   = 0;
+		bool        enabled = false;
+	};
+
+	struct BenchEntries {
+		std::vector<BenchEntry> entries;
+	};
+} // namespace
+
+template <>
+struct JsonBind::Schema<BenchEntry> {
+	static constexpr auto fields = std::tuple{JsonBind::field("id", &BenchEntry::id), JsonBind::field("name", &BenchEntry::name),
+	    JsonBind::field("value", &BenchEntry::value), JsonBind::field("enabled", &BenchEntry::enabled)};
+};
+
+template <>
+struct JsonBind::Schema<BenchEntries> {
+	static constexpr auto fields = std::tuple{JsonBind::field("entries", &BenchEntries::entries)};
+};
+
+namespace Bench {
+	namespace {
+		thread_local AllocStats t_allocStats;
+	}
+
+#ifdef MODUTILS_BENCH_TRACK_ALLOCS
+	bool tracksAllocations() { return true; }
+#else
+	bool tracksAllocations() { return false; }
+#endif
+
+	AllocStats allocStats() { return t_allocStats; }
+
+	// Runner
+	void Runner::add(std::string name, std::function<void()> fn, size_t bytesPerOp) {
+		m_cases.push_back({std::move(name), std::move(fn), bytesPerOp});
+	}
+
+	std::vector<Result> Runner::run(std::string_view filter) const {
+		std::vector<Result> results;
+		results.reserve(m_cases.size());
+
+		for (const auto &benchCase : m_cases) {
+			if (!filter.empty() && benchCase.name.find(filter) == std::string::npos)
+				continue;
+			results.push_back(runCase(benchCase));
+		}
+		return results;
+	}
+
+	Result Runner::runCase(const Case &benchCase) const {
+		using clock = std::chrono::steady_clock;
+
+		auto timeIterations = [&benchCase](uint64_t iterations) {
+			auto start = clock::now();
+			for (uint64_t i = 0; i < iterations; ++i)
+				benchCase.fn();
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start);
+		};
+
+		// warm up, then grow the iteration count until one batch takes at least m_minTime
+		benchCase.fn();
+		uint64_t iterations = 1;
+		while (true) {
+			auto elapsed = timeIterations(iterations);
+			if (elapsed >= m_minTime || iterations >= (1ull << 40))
+				break;
+
+			// aim a bit past the target based on the last measurement, but never grow more than 10x at once
+			double scale = elapsed.count() > 0 ? (1.2 * m_minTime.count() / elapsed.count()) : 10.0;
+			iterations   = std::max(iterations + 1, static_cast<uint64_t>(iterations * std::min(scale, 10.0)));
+		}
+
+		Result result;
+		result.name       = benchCase.name;
+		result.iterations = iterations;
+		result.bytesPerOp = static_cast<double>(benchCase.bytesPerOp);
+
+		double bestNs = std::numeric_limits<double>::max();
+		for (int rep = 0; rep < m_repetitions; ++rep)
+			bestNs = std::min(bestNs, static_cast<double>(timeIterations(iterations).count()));
+		result.nsPerOp = bestNs / iterations;
+
+		if (benchCase.bytesPerOp && result.nsPerOp > 0.0)
+			result.mbPerSec = (benchCase.bytesPerOp / (1024.0 * 1024.0)) / (result.nsPerOp * 1e-9);
+
+		if (tracksAllocations()) {
+			AllocStats before = allocStats();
+			timeIterations(iterations);
+			AllocStats after       = allocStats();
+			result.allocsPerOp     = static_cast<double>(after.count - before.count) / iterations;
+			result.allocBytesPerOp = static_cast<double>(after.bytes - before.bytes) / iterations;
+		}
+
+		return result;
+	}
+
+	std::string formatReport(const std::vector<Result> &results) {
+		size_t nameWidth = 4;
+		for (const auto &r : results)
+			nameWidth = std::max(nameWidth, r.name.size());
+
+		std::string report = std::format(
+		    "{:<{}}  {:>12}  {:>10}  {:>10}  {:>12}  {:>10}\n", "name", nameWidth, "ns/op", "bytes/op", "MB/s", "allocs/op", "iters");
+
+		for (const auto &r : results) {
+			std::string allocs = r.allocsPerOp < 0.0 ? "n/a" : std::format("{:.2f}", r.allocsPerOp);
+			report += std::format("{:<{}}  {:>12.2f}  {:>10.0f}  {:>10.1f}  {:>12}  {:>10}\n",
+			    r.name,
+			    nameWidth,
+			    r.nsPerOp,
+			    r.bytesPerOp,
+			    r.mbPerSec,
+			    allocs,
+			    r.iterations);
+		}
+		return report;
+	}
+
+#ifndef NO_JSON
+	json toJson(const std::vector<Result> &results) {
+		json j;
+		j["tracksAllocations"] = tracksAllocations();
+
+		json &cases = j["results"];
+		cases       = json::object();
+		for (const auto &r : results) {
+			cases[r.name] = {
+			    {"iterations", r.iterations},
+			    {"nsPerOp", r.nsPerOp},
+			    {"bytesPerOp", r.bytesPerOp},
+			    {"mbPerSec", r.mbPerSec},
+			    {"allocsPerOp", r.allocsPerOp},
+			    {"allocBytesPerOp", r.allocBytesPerOp},
+			};
+		}
+		return j;
+	}
+
+	std::vector<Regression> compare(const json &baseline, const std::vector<Result> &current, double thresholdPercent) {
+		std::vector<Regression> regressions;
+
+		if (!baseline.contains("results") || !baseline["results"].is_object()) {
+			LOGERROR("Benchmark baseline JSON has no \"results\" object");
+			return regressions;
+		}
+
+		const json &baseResults = baseline["results"];
+		for (const auto &r : current) {
+			auto it = baseResults.find(r.name);
+			if (it == baseResults.end() || !it->contains("nsPerOp"))
+				continue; // new case, nothing to compare against
+
+			double baseNs = (*it)["nsPerOp"].get<double>();
+			if (baseNs <= 0.0)
+				continue;
+
+			double change = (r.nsPerOp - baseNs) / baseNs * 100.0;
+			if (change > thresholdPercent)
+				regressions.push_back({r.name, baseNs, r.nsPerOp, change});
+		}
+
+		std::sort(regressions.begin(), regressions.end(), [](const Regression &a, const Regression &b) {
+			return a.percentChange > b.percentChange;
+		});
+		return regressions;
+	}
+
+	void logComparison(const std::vector<Regression> &regressions) {
+		if (regressions.empty()) {
+			LOG("No benchmark regressions found");
+			return;
+		}
+
+		LOG("{} benchmark regression(s):", regressions.size());
+		for (const auto &reg : regressions)
+			LOG("  {}: {:.2f} ns/op --> {:.2f} ns/op (+{:.1f}%)", reg.name, reg.baselineNsPerOp, reg.currentNsPerOp, reg.percentChange);
+	}
+#endif
+
+	void addUtilsSuite(Runner &runner, const fs::path &scratchDir) {
+		// shared inputs (captured by value, so the suite outlives this function)
+		const std::string chatLine = "GG EZ! What a SAVE!! Nice shot, #RocketLeague <3 {team} \"quoted\" & 'apostrophe' pls";
+		std::string       bigText;
+		while (bigText.size() < 64 * 1024)
+			bigText += chatLine + "\n";
+		const std::string hexColor = "#FF8800CC";
+
+		// Format::
+		runner.add("Format::construct_label", [codes = std::vector<int>{19, 0, 6, 0, 12, 4, 52, 25, 0}] {
+			std::string out;
+			Format::construct_label(codes, out);
+			doNotOptimize(out);
+		});
+		runner.add("Format::ToASCIIString", [chatLine] { doNotOptimize(Format::ToASCIIString(chatLine)); }, chatLine.size());
+		runner.add("Format::ToASCIIString/64KB", [bigText] { doNotOptimize(Format::ToASCIIString(bigText)); }, bigText.size());
+		runner.add("Format::ToHexString(uintptr_t)", [] { doNotOptimize(Format::ToHexString(uintptr_t{0x7FF6A1B2C3D4})); });
+		runner.add("Format::ToHexString(int32_t, int32_t)", [] { doNotOptimize(Format::ToHexString(int32_t{0xABCD}, 8)); });
+		runner.add("Format::HexToIntPointer", [] { doNotOptimize(Format::HexToIntPointer("7FF6A1B2C3D4")); });
+		runner.add("Format::iContains", [chatLine] { doNotOptimize(Format::iContains(chatLine, "ROCKETLEAGUE")); }, chatLine.size());
+		runner.add("Format::GenRandomString(16)", [] { doNotOptimize(Format::GenRandomString(16)); });
+		runner.add("Format::SplitStrByNewline/64KB", [bigText] { doNotOptimize(Format::SplitStrByNewline(bigText)); }, bigText.size());
+		runner.add("Format::SplitStr(char)", [chatLine] { doNotOptimize(Format::SplitStr(chatLine, ' ')); }, chatLine.size());
+		runner.add("Format::SplitStr(string)", [chatLine] { doNotOptimize(Format::SplitStr(chatLine, ", ")); }, chatLine.size());
+		runner.add("Format::splitAndTrim", [chatLine] { doNotOptimize(Format::splitAndTrim(chatLine, "!")); }, chatLine.size());
+		runner.add("Format::SplitStringInTwo", [chatLine] { doNotOptimize(Format::SplitStringInTwo(chatLine, "#")); }, chatLine.size());
+		runner.add("Format::EscapeBraces", [chatLine] { doNotOptimize(Format::EscapeBraces(chatLine)); }, chatLine.size());
+		runner.add("Format::EscapeQuotesHTML", [chatLine] { doNotOptimize(Format::EscapeQuotesHTML(chatLine)); }, chatLine.size());
+		runner.add(
+		    "Format::UnescapeQuotesHTML",
+		    [escaped = Format::EscapeQuotesHTML(chatLine)] { doNotOptimize(Format::UnescapeQuotesHTML(escaped)); },
+		    chatLine.size());
+		runner.add("Format::RemoveTrailingChar", [chatLine] { doNotOptimize(Format::RemoveTrailingChar(chatLine, 's')); });
+		runner.add("Format::EscapeForHTML", [chatLine] { doNotOptimize(Format::EscapeForHTML(chatLine)); }, chatLine.size());
+		runner.add(
+		    "Format::EscapeForHTMLIncludingSpaces",
+		    [chatLine] { doNotOptimize(Format::EscapeForHTMLIncludingSpaces(chatLine)); },
+		    chatLine.size());
+		runner.add("Format::EscapeCharForHTML", [] { doNotOptimize(Format::EscapeCharForHTML('&')); });
+		runner.add(
+		    "Format::check_string_using_filters",
+		    [chatLine, white = std::vector<std::string>{"save", "SAVE"}, black = std::vector<std::string>{"noob", "bot"}] {
+			    doNotOptimize(Format::check_string_using_filters(chatLine, white, black));
+		    },
+		    chatLine.size());
+		runner.add("Format::toCamelCase", [chatLine] { doNotOptimize(Format::toCamelCase(chatLine)); }, chatLine.size());
+		runner.add("Format::ToLower", [chatLine] { doNotOptimize(Format::ToLower(chatLine)); }, chatLine.size());
+		runner.add("Format::ToLower/64KB", [bigText] { doNotOptimize(Format::ToLower(bigText)); }, bigText.size());
+		runner.add(
+		    "Format::ToLowerInline",
+		    [str = chatLine]() mutable {
+			    Format::ToLowerInline(str);
+			    doNotOptimize(str);
+		    },
+		    chatLine.size());
+		runner.add(
+		    "Format::ToLower (frame arena)",
+		    [chatLine] {
+			    Memory::FrameArena &arena = Memory::frameArena();
+			    arena.Reset();
+			    doNotOptimize(Format::ToLower(chatLine, &arena));
+		    },
+		    chatLine.size());
+		runner.add("Format::RemoveAllChars", [chatLine] { doNotOptimize(Format::RemoveAllChars(chatLine, ' ')); }, chatLine.size());
+		runner.add("Format::RemoveAllChars/64KB", [bigText] { doNotOptimize(Format::RemoveAllChars(bigText, ' ')); }, bigText.size());
+		runner.add(
+		    "Format::RemoveAllCharsInline (incl. copy)",
+		    [chatLine] {
+			    std::string str = chatLine;
+			    Format::RemoveAllCharsInline(str, ' ');
+			    doNotOptimize(str);
+		    },
+		    chatLine.size());
+		runner.add("Format::IsStringHexadecimal", [] { doNotOptimize(Format::IsStringHexadecimal("FF8800CC")); });
+		runner.add("Format::ToHex(void*)", [] { doNotOptimize(Format::ToHex(reinterpret_cast<void *>(0x7FF6A1B2C3D4))); });
+		runner.add("Format::ToHex(uint64_t, size_t)", [] { doNotOptimize(Format::ToHex(uint64_t{0xFF8800}, 6, false)); });
+		runner.add("Format::ToDecimal(string)", [hexColor] { doNotOptimize(Format::ToDecimal(hexColor)); });
+		runner.add("Format::ToDecimal(uint64_t, size_t)", [] { doNotOptimize(Format::ToDecimal(uint64_t{16746496}, 10)); });
+		runner.add("Format::ColorToHex", [] {
+			float rgb[3] = {255.0f, 136.0f, 0.0f};
+			doNotOptimize(Format::ColorToHex(rgb, true));
+		});
+		runner.add("Format::HexToDecimal", [hexColor] { doNotOptimize(Format::HexToDecimal(hexColor)); });
+		runner.add("Format::ToWideString", [chatLine] { doNotOptimize(Format::ToWideString(chatLine)); }, chatLine.size());
+		runner.add(
+		    "Format::ToUTF8String",
+		    [wide = Format::ToWideString(chatLine)] { doNotOptimize(Format::ToUTF8String(wide)); },
+		    chatLine.size());
+
+#ifndef NO_RLSDK
+		// Color / CoolerLinearColor
+		const Color             color{uint8_t{255}, uint8_t{136}, uint8_t{0}, uint8_t{204}};
+		const CoolerLinearColor linear = color.ToLinear();
+
+		runner.add("Color(hex)", [hexColor] { doNotOptimize(Color(hexColor)); });
+		runner.add("Color::ToDecimal", [color] { doNotOptimize(color.ToDecimal()); });
+		runner.add("Color::ToDecimalAlpha", [color] { doNotOptimize(color.ToDecimalAlpha()); });
+		runner.add("Color::ToHex", [color] { doNotOptimize(color.ToHex()); });
+		runner.add("Color::ToHexAlpha", [color] { doNotOptimize(color.ToHexAlpha()); });
+		runner.add("Color::FromDecimal", [] { doNotOptimize(Color().FromDecimal(0xCCFF8800)); });
+		runner.add("Color::FromHex", [hexColor] { doNotOptimize(Color().FromHex(hexColor)); });
+		runner.add("Color::ToLinear", [color] { doNotOptimize(color.ToLinear()); });
+		runner.add("Color::FromLinear", [linear] { doNotOptimize(Color().FromLinear(linear)); });
+		runner.add("Color::Cycle", [c = Color(uint8_t{255}, uint8_t{0}, uint8_t{0}, uint8_t{255})]() mutable {
+			doNotOptimize(c.Cycle());
+		});
+		runner.add("Color::operator<", [color, other = Color(uint8_t{1}, uint8_t{2}, uint8_t{3}, uint8_t{4})] {
+			doNotOptimize(color < other);
+		});
+		runner.add("std::hash<Color>", [color] { doNotOptimize(std::hash<Color>()(color)); });
+		runner.add("CoolerLinearColor::ToColor", [linear] { doNotOptimize(linear.ToColor()); });
+		runner.add("CoolerLinearColor::ToDecimal", [linear] { doNotOptimize(linear.ToDecimal()); });
+		runner.add("CoolerLinearColor::ToHexAlpha", [linear] { doNotOptimize(linear.ToHexAlpha()); });
+		runner.add("CoolerLinearColor::FromHex", [hexColor] { doNotOptimize(CoolerLinearColor().FromHex(hexColor)); });
+		runner.add("GRainbowColor::TickRGB (speed 50)", [] { GRainbowColor::TickRGB(50, 10); });
+		auto rainbow = std::make_shared<RainbowGenerator>();
+		for (size_t i = 0; i < RainbowGenerator::maxChannels; ++i)
+			rainbow->AddChannel(0.1 * (i + 1), 1.0 / (i + 1));
+		runner.add("RainbowGenerator::Update/64 channels", [rainbow, t = 0.0]() mutable { rainbow->Update(t += 1.0 / 120.0); });
+		auto tweener = std::make_shared<Animation::Tweener>();
+		for (size_t i = 0; i < 10000; ++i) {
+			const auto ease = static_cast<Animation::Ease>(i % 9);
+			const auto loop = static_cast<Animation::Loop>(i % 3);
+			tweener->Add(CoolerLinearColor(1.0f, 0.0f, 0.0f, 1.0f), CoolerLinearColor(0.0f, 0.0f, 1.0f, 1.0f), 1.0f + i % 7, ease, loop);
+		}
+		runner.add("Animation::Tweener::Tick/10000 tracks", [tweener] { tweener->Tick(1.0f / 120.0f); });
+		runner.add("std::hash<CoolerLinearColor>", [linear] { doNotOptimize(std::hash<CoolerLinearColor>()(linear)); });
+
+		// Colors::
+		const FColor       fColor  = color.UnrealColor();
+		const FLinearColor fLinear = linear.UnrealColor();
+
+		runner.add("Colors::packColor", [fColor] { doNotOptimize(Colors::packColor(fColor)); });
+		runner.add("Colors::unpackColor", [] { doNotOptimize(Colors::unpackColor(0xCCFF8800)); });
+		runner.add("Colors::fcolorToHex", [fColor] { doNotOptimize(Colors::fcolorToHex(fColor)); });
+		runner.add("Colors::hexToFColor", [] { doNotOptimize(Colors::hexToFColor("CCFF8800")); });
+		runner.add("Colors::fcolorToHexRGBA", [fColor] { doNotOptimize(Colors::fcolorToHexRGBA(fColor)); });
+		runner.add("Colors::hexRGBAtoFColor", [] { doNotOptimize(Colors::hexRGBAtoFColor("0xFF8800CC")); });
+		runner.add("Colors::parseHex (RGB)", [] { doNotOptimize(Colors::parseHex("#FF8800", Colors::HexFormat::RGB)); });
+		runner.add("Colors::parseHex (PrefixedRGBA)", [] {
+			doNotOptimize(Colors::parseHex("0xFF8800CC", Colors::HexFormat::PrefixedRGBA));
+		});
+		{
+			constexpr size_t hexCount = 512;
+			auto             hexStrs  = std::make_shared<std::vector<std::string>>();
+			for (size_t i = 0; i < hexCount; ++i)
+				hexStrs->push_back(Color().FromDecimal(static_cast<uint32_t>(i * 0x9E3779B1u) | 0xFF000000u).ToHexAlpha(false));
+			auto hexViews = std::make_shared<std::vector<std::string_view>>(hexStrs->begin(), hexStrs->end());
+			auto parsed   = std::make_shared<std::vector<Color>>(hexCount);
+			runner.add("Color::FromHex/512", [hexStrs, parsed] {
+				for (size_t i = 0; i < hexCount; ++i)
+					(*parsed)[i] = Color().FromHex((*hexStrs)[i]);
+				doNotOptimize(parsed->data());
+			});
+			runner.add("Colors::parseHexBatch/512", [hexStrs, hexViews, parsed] {
+				doNotOptimize(Colors::parseHexBatch(hexViews->data(), parsed->data(), hexCount, Colors::HexFormat::RGBA));
+			});
+		}
+		runner.add("Colors::FLinearColorToInt", [fLinear] { doNotOptimize(Colors::FLinearColorToInt(fLinear)); });
+		runner.add("Colors::fLinearColorToFColor", [fLinear] { doNotOptimize(Colors::fLinearColorToFColor(fLinear)); });
+		runner.add("Colors::fColorToFLinearColor", [fColor] { doNotOptimize(Colors::fColorToFLinearColor(fColor)); });
+		runner.add("Colors::toFColor", [] {
+			const float rgba[4] = {1.0f, 0.53f, 0.0f, 0.8f};
+			doNotOptimize(Colors::toFColor(rgba));
+		});
+
+		constexpr size_t imagePixels = 1024 * 1024;
+		auto             pixels      = std::make_shared<std::vector<uint8_t>>(imagePixels * 4, uint8_t{128});
+		runner.add(
+		    "Colors::rgbaToBGRASwizzle/1024x1024",
+		    [pixels] {
+			    Colors::rgbaToBGRASwizzle(pixels->data(), imagePixels);
+			    doNotOptimize(pixels->data());
+		    },
+		    imagePixels * 4);
+		runner.add(
+		    "Colors::swizzleChannels (scalar reference)/1024x1024",
+		    [pixels] {
+			    // the per-pixel swap loop swizzleChannels used before the vectorized engine
+			    uint8_t *data = pixels->data();
+			    for (size_t i = 0; i < imagePixels; ++i)
+				    std::swap(data[i * 4], data[i * 4 + 2]);
+			    doNotOptimize(data);
+		    },
+		    imagePixels * 4);
+
+		constexpr size_t uhdPixels = 3840 * 2160;
+		auto             rgbPixels = std::make_shared<std::vector<uint8_t>>(uhdPixels * 3, uint8_t{128});
+		auto             uhdRgba   = std::make_shared<std::vector<uint8_t>>(uhdPixels * 4, uint8_t{128});
+		runner.add(
+		    "Colors::swizzle (RGBA->BGRA)/3840x2160",
+		    [uhdRgba] {
+			    Colors::swizzle(uhdRgba->data(), uhdRgba->data(), uhdPixels, Colors::rgbaToBgra);
+			    doNotOptimize(uhdRgba->data());
+		    },
+		    uhdPixels * 4);
+		runner.add(
+		    "Colors::swizzleParallel (RGBA->BGRA)/3840x2160",
+		    [uhdRgba] {
+			    Colors::swizzleParallel(uhdRgba->data(), uhdRgba->data(), uhdPixels, Colors::rgbaToBgra);
+			    doNotOptimize(uhdRgba->data());
+		    },
+		    uhdPixels * 4);
+		runner.add(
+		    "Colors::swizzle (RGB->RGBA)/3840x2160",
+		    [rgbPixels, uhdRgba] {
+			    Colors::swizzle(rgbPixels->data(), uhdRgba->data(), uhdPixels, Colors::rgbToRgba);
+			    doNotOptimize(uhdRgba->data());
+		    },
+		    uhdPixels * 3);
+		runner.add(
+		    "Colors::swizzle (RGBA->RGB)/3840x2160",
+		    [rgbPixels, uhdRgba] {
+			    Colors::swizzle(uhdRgba->data(), rgbPixels->data(), uhdPixels, Colors::rgbaToRgb);
+			    doNotOptimize(rgbPixels->data());
+		    },
+		    uhdPixels * 4);
+
+		// texture preparation: three whole-image passes vs. the same stages fused per tile
+		const Color tint(uint8_t{255}, uint8_t{200}, uint8_t{180}, uint8_t{230});
+		auto        swizzlePass     = std::make_shared<Colors::PixelPipeline>();
+		auto        tintPass        = std::make_shared<Colors::PixelPipeline>();
+		auto        premultiplyPass = std::make_shared<Colors::PixelPipeline>();
+		auto        fused           = std::make_shared<Colors::PixelPipeline>();
+		swizzlePass->Swizzle(Colors::rgbaToBgra);
+		tintPass->Tint(tint);
+		premultiplyPass->Premultiply();
+		fused->Swizzle(Colors::rgbaToBgra).Tint(tint).Premultiply();
+		runner.add(
+		    "Colors::PixelPipeline (separate passes)/3840x2160",
+		    [uhdRgba, swizzlePass, tintPass, premultiplyPass] {
+			    for (const auto &pass : {swizzlePass, tintPass, premultiplyPass})
+				    pass->Run(uhdRgba->data(), uhdRgba->data(), uhdPixels, 1);
+			    doNotOptimize(uhdRgba->data());
+		    },
+		    uhdPixels * 4);
+		runner.add(
+		    "Colors::PixelPipeline (fused)/3840x2160",
+		    [uhdRgba, fused] {
+			    fused->Run(uhdRgba->data(), uhdRgba->data(), uhdPixels, 1);
+			    doNotOptimize(uhdRgba->data());
+		    },
+		    uhdPixels * 4);
+		runner.add(
+		    "Colors::PixelPipeline (fused, all threads)/3840x2160",
+		    [uhdRgba, fused] {
+			    fused->Run(uhdRgba->data(), uhdRgba->data(), uhdPixels);
+			    doNotOptimize(uhdRgba->data());
+		    },
+		    uhdPixels * 4);
+
+		// palette matching, 90 entries is roughly the size of the in-game paint palette
+		auto paletteColors = std::make_shared<std::vector<Color>>();
+		for (uint32_t i = 0; i < 90; ++i)
+			paletteColors->push_back(Color().FromDecimal((i * 0x9E3779B1u) >> 8));
+		auto matcher = std::make_shared<Colors::PaletteMatcher>(*paletteColors);
+		auto queries = std::make_shared<std::vector<Color>>();
+		for (uint32_t i = 0; i < 4096; ++i)
+			queries->push_back(Color().FromDecimal((i * 0x85EBCA6Bu) >> 8));
+		auto matches = std::make_shared<std::vector<uint32_t>>(queries->size());
+		runner.add("Colors::PaletteMatcher::Build (32^3)", [paletteColors] {
+			doNotOptimize(Colors::PaletteMatcher(*paletteColors).Palette().size());
+		});
+		runner.add("Colors::PaletteMatcher::NearestBruteForce/4096", [matcher, queries, matches] {
+			for (size_t i = 0; i < queries->size(); ++i)
+				(*matches)[i] = matcher->NearestBruteForce((*queries)[i]);
+			doNotOptimize(matches->data());
+		});
+		runner.add("Colors::PaletteMatcher::NearestBatch/4096", [matcher, queries, matches] {
+			matcher->NearestBatch(queries->data(), matches->data(), queries->size());
+			doNotOptimize(matches->data());
+		});
+
+		constexpr size_t tableSize   = 64 * 1024;
+		auto             linearTable = std::make_shared<std::vector<FLinearColor>>(tableSize, fLinear);
+		auto             byteTable   = std::make_shared<std::vector<FColor>>(tableSize, fColor);
+		runner.add(
+		    "Colors::linearToFColors/64K",
+		    [linearTable, byteTable] {
+			    Colors::linearToFColors(linearTable->data(), byteTable->data(), tableSize);
+			    doNotOptimize(byteTable->data());
+		    },
+		    tableSize * sizeof(FLinearColor));
+		runner.add(
+		    "Colors::linearToFColors (sRGB)/64K",
+		    [linearTable, byteTable] {
+			    Colors::linearToFColors(linearTable->data(), byteTable->data(), tableSize, {.sRGB = true});
+			    doNotOptimize(byteTable->data());
+		    },
+		    tableSize * sizeof(FLinearColor));
+		runner.add(
+		    "Colors::fColorsToLinear/64K",
+		    [linearTable, byteTable] {
+			    Colors::fColorsToLinear(byteTable->data(), linearTable->data(), tableSize);
+			    doNotOptimize(linearTable->data());
+		    },
+		    tableSize * sizeof(FColor));
+#endif // NO_RLSDK
+
+		// Files::
+		std::error_code ec;
+		fs::create_directories(scratchDir, ec);
+		if (ec) {
+			LOGERROR("Unable to create benchmark scratch directory '{}': {}", scratchDir.string(), ec.message());
+			return;
+		}
+
+		const fs::path textFile = scratchDir / "bench_text.txt";
+		{
+			std::ofstream out(textFile, std::ios::binary | std::ios::trunc);
+			for (int i = 0; i < 16; ++i)
+				out << bigText; // ~1 MB
+		}
+		const size_t textSize = static_cast<size_t>(fs::file_size(textFile, ec));
+		runner.add("Files::get_text_content/1MB", [textFile] { doNotOptimize(Files::get_text_content(textFile)); }, textSize);
+
+#ifndef NO_JSON
+		const fs::path jsonFile = scratchDir / "bench_data.json";
+		{
+			json j;
+			for (int i = 0; i < 2000; ++i)
+				j["entries"].push_back({{"id", Format::GenRandomString(12)}, {"name", chatLine}, {"value", i}, {"enabled", i % 2 == 0}});
+			Files::write_json(jsonFile, j);
+		}
+		const size_t jsonSize = static_cast<size_t>(fs::file_size(jsonFile, ec));
+		runner.add("Files::get_json/2000 entries", [jsonFile] { doNotOptimize(Files::get_json(jsonFile)); }, jsonSize);
+		runner.add(
+		    "Files::get_json_as/2000 entries",
+		    [jsonFile] {
+			    BenchEntries entries;
+			    doNotOptimize(Files::get_json_as(jsonFile, entries));
+			    doNotOptimize(entries);
+		    },
+		    jsonSize);
+		runner.add(
+		    "Files::write_json/2000 entries",
+		    [jsonFile, j = Files::get_json(jsonFile)] { doNotOptimize(Files::write_json(jsonFile, j)); },
+		    jsonSize);
+#endif
+
+		const fs::path imageDir = scratchDir / "bench_images";
+		fs::create_directories(imageDir / "nested", ec);
+		for (int i = 0; i < 500; ++i) {
+			static constexpr std::array<std::string_view, 5> extensions = {".png", ".PNG", ".jpg", ".bmp", ".txt"};
+			const fs::path dir = (i % 2) ? imageDir : imageDir / "nested";
+			std::ofstream(dir / std::format("image_{}{}", i, extensions[i % extensions.size()]));
+		}
+		runner.add("Files::FindImages/500 files", [imageDir] {
+			std::unordered_map<std::string, fs::path> images;
+			Files::FindImages(imageDir, images);
+			doNotOptimize(images);
+		});
+		runner.add("Files::FindPngImages/500 files", [imageDir] {
+			std::unordered_map<std::string, fs::path> images;
+			Files::FindPngImages(imageDir, images);
+			doNotOptimize(images);
+		});
+		runner.add("Files::FindImages (uncached)/500 files", [imageDir] {
+			Files::ClearImageScanCache();
+			std::unordered_map<std::string, fs::path> images;
+			Files::FindImages(imageDir, images);
+			doNotOptimize(images);
+		});
+	}
+
+	size_t checkStringKernels(size_t iterations, uint64_t seed) {
+		// the straightforward versions the vectorized kernels replaced. tolower is called on unsigned char, so bytes >= 0x80 stay put
+		// like they do in the "C" locale
+		auto refToLower = [](std::string str) {
+			std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+			return str;
+		};
+		auto refToASCII = [](std::string str) {
+			str.erase(std::remove_if(str.begin(), str.end(), [](unsigned char c) { return c > 127; }), str.end());
+			return str;
+		};
+		auto refRemoveAll = [](std::string str, char character) {
+			str.erase(std::remove(str.begin(), str.end(), character), str.end());
+			return str;
+		};
+
+		std::mt19937_64 rng{seed};
+		size_t          failures = 0;
+
+		auto check = [&failures](std::string_view name, const std::string &input, const std::string &got, const std::string &expected) {
+			if (got == expected)
+				return;
+			if (failures++ >= 10)
+				return;
+			// inputs are mostly binary, so report where the outputs diverge rather than the strings themselves
+			const size_t at = std::mismatch(got.begin(), got.end(), expected.begin(), expected.end()).first - got.begin();
+			LOGERROR("{} mismatch on a {} byte input: outputs differ at byte {} ({} vs {} bytes)",
+			    name,
+			    input.size(),
+			    at,
+			    got.size(),
+			    expected.size());
+		};
+
+		std::string input;
+		for (size_t i = 0; i < iterations; ++i) {
+			// lengths straddle the 16/32 byte block sizes, and the byte mix is drawn per input so some are mostly letters, some mostly
+			// high bytes, and some dense with the character being removed
+			const size_t   length   = rng() % 200;
+			const char     removed  = static_cast<char>(rng());
+			const uint64_t dominant = rng() % 4; // byte class that about half of this input is drawn from
+			input.resize(length);
+			for (char &c : input) {
+				const uint64_t r = rng();
+				switch ((r >> 63) ? dominant : (r >> 40) % 4) {
+				case 0:
+					c = static_cast<char>(r);
+					break;
+				case 1:
+					c = static_cast<char>((r & 1 ? 'A' : 'a') + (r >> 16) % 26);
+					break;
+				case 2:
+					c = static_cast<char>(0x80 | r);
+					break;
+				default:
+					c = removed;
+					break;
+				}
+			}
+
+			std::string lower = input;
+			Format::ToLowerInline(lower);
+			check("Format::ToLowerInline", input, lower, refToLower(input));
+			check("Format::ToLower", input, Format::ToLower(input), refToLower(input));
+
+			std::string ascii = input;
+			Format::ToASCIIStringInline(ascii);
+			check("Format::ToASCIIStringInline", input, ascii, refToASCII(input));
+			check("Format::ToASCIIString", input, Format::ToASCIIString(input), refToASCII(input));
+
+			std::string stripped = input;
+			Format::RemoveAllCharsInline(stripped, removed);
+			check("Format::RemoveAllCharsInline", input, stripped, refRemoveAll(input, removed));
+			check("Format::RemoveAllChars", input, Format::RemoveAllChars(input, removed), refRemoveAll(input, removed));
+		}
+
+		if (failures)
+			LOGERROR("{} string kernel mismatch(es) in {} random inputs (seed {})", failures, iterations, seed);
+		else
+			LOG("String kernels match the reference implementations on {} random inputs", iterations);
+		return failures;
+	}
+} // namespace Bench
+
+#ifdef MODUTILS_BENCH_TRACK_ALLOCS
+// Replacing these is module-wide, which is why it's opt-in. The array/nothrow forms forward here by default
+void *operator new(size_t size) {
+	++Bench::t_allocStats.count;
+	Bench::t_allocStats.bytes += size;
+	if (void *ptr = std::malloc(size ? size : 1))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+#endif
@@ -0,0 +1,101 @@
+#pragma once
+#include "pch.h"
+#include <chrono>
+
+/*
+    Tiny microbenchmark harness, so perf changes to this library can be measured instead of guessed.
+
+    USAGE:
+        Bench::Runner runner;
+        Bench::addUtilsSuite(runner, scratchDir);      // or runner.add("name", [] { ... }, bytesPerOp);
+        auto results = runner.run();
+        LOG("{}", Bench::formatReport(results));
+
+        // compare against a previous commit's output
+        Files::write_json(dir / "bench_current.json", Bench::toJson(results));
+        Bench::logComparison(Bench::compare(Files::get_json(dir / "bench_baseline.json"), results, 10.0));
+
+        // correctness, not speed: the SIMD string kernels against their reference implementations
+        Bench::checkStringKernels();
+
+    Allocation counts are only recorded when the library is built with MODUTILS_BENCH_TRACK_ALLOCS, since that replaces the global
+    operator new/delete for the whole module.
+*/
+namespace Bench {
+	namespace detail {
+		inline const void *volatile sink = nullptr;
+	}
+
+	// Keeps the optimizer from discarding a value that's otherwise unused
+	template <typename T>
+	inline void doNotOptimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		detail::sink = static_cast<const void *>(&value);
+#endif
+	}
+
+	struct AllocStats {
+		uint64_t count = 0;
+		uint64_t bytes = 0;
+	};
+
+	bool       tracksAllocations();
+	AllocStats allocStats(); // counters for the calling thread
+
+	struct Result {
+		std::string name;
+		uint64_t    iterations      = 0;
+		double      nsPerOp         = 0.0;
+		double      bytesPerOp      = 0.0;  // bytes processed per op, as declared when the case was added
+		double      mbPerSec        = 0.0;  // throughput derived from bytesPerOp (0 if not declared)
+		double      allocsPerOp     = -1.0; // -1 when allocation tracking isn't compiled in
+		double      allocBytesPerOp = -1.0;
+	};
+
+	struct Case {
+		std::string           name;
+		std::function<void()> fn;
+		size_t                bytesPerOp = 0;
+	};
+
+	class Runner {
+		std::vector<Case>        m_cases;
+		std::chrono::nanoseconds m_minTime     = std::chrono::milliseconds(50); // per repetition
+		int                      m_repetitions = 3;                             // best repetition is reported
+
+	public:
+		void add(std::string name, std::function<void()> fn, size_t bytesPerOp = 0);
+		void setMinTime(std::chrono::nanoseconds minTime) { m_minTime = minTime; }
+		void setRepetitions(int repetitions) { m_repetitions = std::max(repetitions, 1); }
+
+		// runs every case whose name contains `filter` (all of them if empty)
+		std::vector<Result> run(std::string_view filter = {}) const;
+		Result              runCase(const Case &benchCase) const;
+	};
+
+	std::string formatReport(const std::vector<Result> &results);
+
+#ifndef NO_JSON
+	struct Regression {
+		std::string name;
+		double      baselineNsPerOp = 0.0;
+		double      currentNsPerOp  = 0.0;
+		double      percentChange   = 0.0; // positive = slower
+	};
+
+	json                    toJson(const std::vector<Result> &results);
+	std::vector<Regression> compare(const json &baseline, const std::vector<Result> &current, double thresholdPercent = 10.0);
+	void                    logComparison(const std::vector<Regression> &regressions);
+#endif
+
+	// Registers cases for the Format::, Color/CoolerLinearColor, Colors:: and Files:: functions. File cases write their inputs into
+	// scratchDir (created if needed)
+	void addUtilsSuite(Runner &runner, const fs::path &scratchDir);
+
+	// Compares the vectorized Format::ToLower/ToASCIIString/RemoveAllChars (and their Inline variants) against the plain
+	// std::transform/remove_if/remove code they replaced, over `iterations` random inputs. Logs mismatches and returns how many there
+	// were, so 0 means they agree. Run it with both SIMD and scalar builds after touching those kernels
+	size_t checkStringKernels(size_t iterations = 50000, uint64_t seed = 0x5EED);
+} // namespace Bench
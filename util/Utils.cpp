@@ -1,12 +1,41 @@
 #include "pch.h"
 #include "Utils.hpp"
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <list>
+#include <numeric>
 #include <optional>
 #include <random>
 #include <regex>
 #include <shellapi.h>
 #include <stdexcept>
+#include <thread>
 #pragma comment(lib, "Shlwapi.lib")
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MODUTILS_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(__SSSE3__) || defined(__AVX__)
+#define MODUTILS_SSSE3
+#include <tmmintrin.h>
+#endif
+#ifdef __AVX2__
+#define MODUTILS_AVX2
+#include <immintrin.h>
+#endif
+
 namespace Memory {
 	PatternData::~PatternData() {
 		delete[] arrayOfBytes;
@@ -164,22 +193,127 @@ namespace Memory {
 		int32_t   displacement          = *reinterpret_cast<int32_t *>(ripRelativeOffsetAddr);
 		return (ripRelativeOffsetAddr + 4) + displacement;
 	}
+
+	FrameArena::FrameArena(size_t initialCapacity) {
+		m_stats.capacity = std::max<size_t>(initialCapacity, 1024);
+		m_buffer         = std::make_unique_for_overwrite<std::byte[]>(m_stats.capacity);
+		m_resource.emplace(m_buffer.get(), m_stats.capacity, std::pmr::new_delete_resource());
+	}
+
+	void *FrameArena::do_allocate(size_t bytes, size_t alignment) {
+		m_stats.used += bytes;
+		m_stats.peak = std::max(m_stats.peak, m_stats.used);
+
+		void *ptr = m_resource->allocate(bytes, alignment);
+
+		// anything outside our buffer came from the upstream heap
+		const auto *p = static_cast<const std::byte *>(ptr);
+		if (p < m_buffer.get() || p >= m_buffer.get() + m_stats.capacity)
+			m_overflowed = true;
+		return ptr;
+	}
+
+	void FrameArena::Reset() {
+		if (m_overflowed) {
+			// grow so a frame like this one fits next time (with headroom for alignment padding)
+			m_stats.overflows++;
+			m_stats.capacity = std::bit_ceil(m_stats.used + m_stats.used / 2);
+
+			m_resource.reset();
+			m_buffer = std::make_unique_for_overwrite<std::byte[]>(m_stats.capacity);
+			m_resource.emplace(m_buffer.get(), m_stats.capacity, std::pmr::new_delete_resource());
+		} else
+			m_resource->release();
+
+		m_stats.used = 0;
+		m_stats.frames++;
+		m_overflowed = false;
+	}
+
+	void FrameArena::LogStats() const {
+		LOG("Frame arena: {} bytes used this frame, {} peak, {} capacity, {} overflows in {} frames",
+		    m_stats.used,
+		    m_stats.peak,
+		    m_stats.capacity,
+		    m_stats.overflows,
+		    m_stats.frames);
+	}
+
+	const char *FrameArena::CopyString(std::string_view str) {
+		char *out = static_cast<char *>(allocate(str.size() + 1, alignof(char)));
+		if (!str.empty())
+			std::memcpy(out, str.data(), str.size());
+		out[str.size()] = '\0';
+		return out;
+	}
+
+	FrameArena &frameArena() {
+		thread_local FrameArena arena;
+		return arena;
+	}
 } // namespace Memory
 
 namespace Format {
 	void construct_label(const std::vector<int> &codes, std::string &out_str) {
 		out_str.clear();
+		out_str.reserve(codes.size());
 
 		for (int code : codes)
 			out_str += letters[code];
 	}
 
+	namespace {
+		// Compacts str in place, dropping every byte for which removeMask/shouldRemove is true. Blocks with nothing to remove are
+		// stored whole, others are compacted by walking the keep-mask. Stores never pass the read cursor, so this is safe in place
+		template <typename MaskFn, typename Pred>
+		void removeBytesInline(std::string &str, MaskFn removeMask, Pred shouldRemove) {
+			char       *out = str.data();
+			const char *in  = str.data();
+			const char *end = str.data() + str.size();
+
+#ifdef MODUTILS_SSE2
+			while (end - in >= 16) {
+				const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in));
+				uint32_t      keep  = ~static_cast<uint32_t>(_mm_movemask_epi8(removeMask(block))) & 0xFFFF;
+
+				if (keep == 0xFFFF) {
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(out), block);
+					out += 16;
+				} else {
+					while (keep) {
+						*out++ = in[std::countr_zero(keep)];
+						keep &= keep - 1;
+					}
+				}
+				in += 16;
+			}
+#else
+			(void)removeMask;
+#endif
+			for (; in < end; ++in) {
+				if (!shouldRemove(static_cast<unsigned char>(*in)))
+					*out++ = *in;
+			}
+
+			str.resize(out - str.data());
+		}
+	} // namespace
+
 	std::string ToASCIIString(std::string str) {
-		// Remove non-ASCII characters
-		str.erase(std::remove_if(str.begin(), str.end(), [](unsigned char c) { return c > 127; }), str.end());
+		ToASCIIStringInline(str);
 		return str;
 	}
 
+	// Remove non-ASCII characters
+	void ToASCIIStringInline(std::string &str) {
+#ifdef MODUTILS_SSE2
+		auto removeMask = [](__m128i block) { return block; }; // movemask already picks out the high bit of each byte
+#else
+		auto removeMask = [](auto) { return 0; };
+#endif
+		removeBytesInline(str, removeMask, [](unsigned char c) { return c > 127; });
+	}
+
 	std::string ToHexString(uintptr_t address) {
 		// Adjust width based on the platform's pointer size
 		constexpr int pointerWidth = sizeof(uintptr_t) * 2; // Each byte is 2 hex digits
@@ -221,23 +355,7 @@ namespace Format {
 	}
 #endif
 
-	std::string GenRandomString(int length) {
-		// Define character set
-		const std::string charset = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
-
-		// Initialize random number generator
-		std::random_device                 rd;
-		std::mt19937                       gen(rd());
-		std::uniform_int_distribution<int> distr(0, charset.length() - 1);
-
-		// Generate random string
-		std::string randomString;
-		randomString.reserve(length);
-		for (int i = 0; i < length; ++i)
-			randomString += charset[distr(gen)];
-
-		return randomString;
-	}
+	std::string GenRandomString(int length) { return Random::genString(length > 0 ? static_cast<size_t>(length) : 0); }
 
 	std::vector<std::string> SplitStrByNewline(const std::string &input) {
 		std::vector<std::string> lines;
@@ -500,18 +618,57 @@ namespace Format {
 	}
 
 	std::string ToLower(std::string str) {
-		std::transform(str.begin(), str.end(), str.begin(), tolower);
+		ToLowerInline(str);
 		return str;
 	}
 
-	void ToLowerInline(std::string &str) { std::transform(str.begin(), str.end(), str.begin(), tolower); }
+	namespace {
+		// ASCII case folding (same result as tolower in the "C" locale). Bytes >= 0x80 are left untouched
+		void toLowerBytes(char *data, size_t size) {
+			size_t i = 0;
+
+#ifdef MODUTILS_SSE2
+			// bytes >= 0x80 are negative as signed chars, so the signed range compare skips them for free
+			const __m128i beforeA = _mm_set1_epi8('A' - 1);
+			const __m128i afterZ  = _mm_set1_epi8('Z' + 1);
+			const __m128i caseBit = _mm_set1_epi8(0x20);
+			for (; i + 16 <= size; i += 16) {
+				const __m128i block   = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+				const __m128i isUpper = _mm_and_si128(_mm_cmpgt_epi8(block, beforeA), _mm_cmplt_epi8(block, afterZ));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(data + i), _mm_or_si128(block, _mm_and_si128(isUpper, caseBit)));
+			}
+#endif
+			for (; i < size; ++i) {
+				if (data[i] >= 'A' && data[i] <= 'Z')
+					data[i] |= 0x20;
+			}
+		}
+	} // namespace
+
+	void ToLowerInline(std::string &str) { toLowerBytes(str.data(), str.size()); }
+
+	std::pmr::string ToLower(std::string_view str, std::pmr::memory_resource *mem) {
+		std::pmr::string out{str, mem};
+		toLowerBytes(out.data(), out.size());
+		return out;
+	}
+
+	void ToLowerInline(std::pmr::string &str) { toLowerBytes(str.data(), str.size()); }
 
 	std::string RemoveAllChars(std::string str, char character) {
-		str.erase(std::remove(str.begin(), str.end(), character), str.end());
+		RemoveAllCharsInline(str, character);
 		return str;
 	}
 
-	void RemoveAllCharsInline(std::string &str, char character) { str.erase(std::remove(str.begin(), str.end(), character), str.end()); }
+	void RemoveAllCharsInline(std::string &str, char character) {
+#ifdef MODUTILS_SSE2
+		const __m128i needle     = _mm_set1_epi8(character);
+		auto          removeMask = [needle](__m128i block) { return _mm_cmpeq_epi8(block, needle); };
+#else
+		auto removeMask = [](auto) { return 0; };
+#endif
+		removeBytesInline(str, removeMask, [character](unsigned char c) { return c == static_cast<unsigned char>(character); });
+	}
 
 	bool IsStringHexadecimal(std::string str) {
 		if (str.empty())
@@ -577,6 +734,196 @@ namespace Format {
 		stream >> decimal;
 		return decimal;
 	}
+
+	namespace {
+		constexpr char32_t replacementChar = 0xFFFD;
+
+		// Decodes one UTF-8 sequence starting at in[i] and advances i. Overlong forms, surrogates and values above U+10FFFF are
+		// rejected up front by the allowed range of the second byte, so each invalid subsequence becomes exactly one U+FFFD
+		char32_t decodeUTF8(std::string_view in, size_t &i) {
+			const auto lead = static_cast<uint8_t>(in[i++]);
+			if (lead < 0x80)
+				return lead;
+
+			size_t   extra = 0;
+			char32_t cp    = 0;
+			uint8_t  lo    = 0x80; // allowed range of the first continuation byte
+			uint8_t  hi    = 0xBF;
+			if (lead >= 0xC2 && lead <= 0xDF) {
+				extra = 1;
+				cp    = lead & 0x1F;
+			} else if (lead >= 0xE0 && lead <= 0xEF) {
+				extra = 2;
+				cp    = lead & 0x0F;
+				if (lead == 0xE0)
+					lo = 0xA0;
+				else if (lead == 0xED)
+					hi = 0x9F;
+			} else if (lead >= 0xF0 && lead <= 0xF4) {
+				extra = 3;
+				cp    = lead & 0x07;
+				if (lead == 0xF0)
+					lo = 0x90;
+				else if (lead == 0xF4)
+					hi = 0x8F;
+			} else
+				return replacementChar; // stray continuation byte or invalid lead byte
+
+			for (size_t k = 0; k < extra; ++k) {
+				if (i >= in.size())
+					return replacementChar;
+
+				const auto cont = static_cast<uint8_t>(in[i]);
+				if (cont < lo || cont > hi)
+					return replacementChar; // the bad byte isn't consumed, so it starts the next sequence
+
+				cp = (cp << 6) | (cont & 0x3F);
+				lo = 0x80;
+				hi = 0xBF;
+				++i;
+			}
+			return cp;
+		}
+
+		void encodeWide(char32_t cp, wchar_t *&out) {
+			if constexpr (sizeof(wchar_t) == 2) {
+				if (cp >= 0x10000) {
+					cp -= 0x10000;
+					*out++ = static_cast<wchar_t>(0xD800 + (cp >> 10));
+					*out++ = static_cast<wchar_t>(0xDC00 + (cp & 0x3FF));
+					return;
+				}
+			}
+			*out++ = static_cast<wchar_t>(cp);
+		}
+
+		// Decodes one wide char (or UTF-16 surrogate pair) starting at in[i] and advances i
+		char32_t decodeWide(std::wstring_view in, size_t &i) {
+			const auto unit = static_cast<char32_t>(in[i++]);
+			if constexpr (sizeof(wchar_t) == 2) {
+				if (unit >= 0xD800 && unit <= 0xDBFF && i < in.size()) {
+					const auto low = static_cast<char32_t>(in[i]);
+					if (low >= 0xDC00 && low <= 0xDFFF) {
+						++i;
+						return 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+					}
+				}
+			}
+			if ((unit >= 0xD800 && unit <= 0xDFFF) || unit > 0x10FFFF)
+				return replacementChar; // lone surrogate or out of range
+			return unit;
+		}
+
+		void encodeUTF8(char32_t cp, char *&out) {
+			if (cp < 0x80)
+				*out++ = static_cast<char>(cp);
+			else if (cp < 0x800) {
+				*out++ = static_cast<char>(0xC0 | (cp >> 6));
+				*out++ = static_cast<char>(0x80 | (cp & 0x3F));
+			} else if (cp < 0x10000) {
+				*out++ = static_cast<char>(0xE0 | (cp >> 12));
+				*out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+				*out++ = static_cast<char>(0x80 | (cp & 0x3F));
+			} else {
+				*out++ = static_cast<char>(0xF0 | (cp >> 18));
+				*out++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+				*out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+				*out++ = static_cast<char>(0x80 | (cp & 0x3F));
+			}
+		}
+	} // namespace
+
+	std::wstring ToWideString(std::string_view str) {
+		// each UTF-8 byte produces at most one UTF-16/UTF-32 unit, so size once and shrink afterwards
+		std::wstring result(str.size(), L'\0');
+		wchar_t     *out = result.data();
+		size_t       i   = 0;
+
+		while (i < str.size()) {
+#ifdef MODUTILS_SSE2
+			// ASCII fast path: widen 16 bytes per step while the high bits are clear
+			const __m128i zero = _mm_setzero_si128();
+			while (str.size() - i >= 16) {
+				const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(str.data() + i));
+				if (_mm_movemask_epi8(bytes) != 0)
+					break;
+
+				const __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+				const __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+				if constexpr (sizeof(wchar_t) == 2) {
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(out), lo);
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(out + 8), hi);
+				} else {
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_unpacklo_epi16(lo, zero));
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(out + 4), _mm_unpackhi_epi16(lo, zero));
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(out + 8), _mm_unpacklo_epi16(hi, zero));
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(out + 12), _mm_unpackhi_epi16(hi, zero));
+				}
+				out += 16;
+				i += 16;
+			}
+			if (i >= str.size())
+				break;
+#endif
+			encodeWide(decodeUTF8(str, i), out);
+		}
+
+		result.resize(out - result.data());
+		return result;
+	}
+
+	std::string ToUTF8String(std::wstring_view str) {
+		// worst case is 3 bytes per UTF-16 unit (a surrogate pair is 2 units --> 4 bytes), or 4 bytes per UTF-32 unit
+		constexpr size_t maxBytesPerUnit = sizeof(wchar_t) == 2 ? 3 : 4;
+		std::string      result(str.size() * maxBytesPerUnit, '\0');
+		char       *out = result.data();
+		size_t      i   = 0;
+
+		while (i < str.size()) {
+#ifdef MODUTILS_SSE2
+			// ASCII fast path: narrow 16 units per step while every unit is below 0x80
+			if constexpr (sizeof(wchar_t) == 2) {
+				const __m128i nonAsciiMask = _mm_set1_epi16(static_cast<short>(0xFF80));
+				while (str.size() - i >= 16) {
+					const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(str.data() + i));
+					const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(str.data() + i + 8));
+
+					const __m128i highBits = _mm_and_si128(_mm_or_si128(a, b), nonAsciiMask);
+					if (_mm_movemask_epi8(_mm_cmpeq_epi16(highBits, _mm_setzero_si128())) != 0xFFFF)
+						break;
+
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_packus_epi16(a, b));
+					out += 16;
+					i += 16;
+				}
+			} else {
+				const __m128i nonAsciiMask = _mm_set1_epi32(static_cast<int>(0xFFFFFF80));
+				while (str.size() - i >= 16) {
+					const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(str.data() + i));
+					const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(str.data() + i + 4));
+					const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(str.data() + i + 8));
+					const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(str.data() + i + 12));
+
+					const __m128i highBits = _mm_and_si128(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)), nonAsciiMask);
+					if (_mm_movemask_epi8(_mm_cmpeq_epi32(highBits, _mm_setzero_si128())) != 0xFFFF)
+						break;
+
+					const __m128i ab = _mm_packs_epi32(a, b);
+					const __m128i cd = _mm_packs_epi32(c, d);
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_packus_epi16(ab, cd));
+					out += 16;
+					i += 16;
+				}
+			}
+			if (i >= str.size())
+				break;
+#endif
+			encodeUTF8(decodeWide(str, i), out);
+		}
+
+		result.resize(out - result.data());
+		return result;
+	}
 } // namespace Format
 
 namespace Math {
@@ -590,240 +937,2862 @@ namespace Math {
 #endif // NO_RLSDK
 } // namespace Math
 
-namespace Helper {
-#ifndef NO_JSON
-	std::optional<json> getJsonFromStr(const std::string &str) {
-		try {
-			return json::parse(str);
-		} catch (...) {
-			LOGERROR("Unable to parse JSON!");
-			return std::nullopt;
+namespace Random {
+	namespace {
+		uint64_t splitMix64(uint64_t &x) {
+			uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+			z          = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z          = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			return z ^ (z >> 31);
 		}
-	}
-#endif
-} // namespace Helper
 
-namespace Files {
-	void FindPngImages(const fs::path &directory, std::unordered_map<std::string, fs::path> &imageMap) {
-		for (const auto &entry : fs::recursive_directory_iterator(directory)) {
-			if (entry.is_regular_file() && entry.path().extension() == ".png") {
-				// Get the filename without extension
-				std::string filename = entry.path().stem().string();
-				// Get the full path
-				fs::path filepath = entry.path();
-				// Add to map
-				imageMap[filename] = filepath;
+		uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+		struct Xoshiro256 {
+			uint64_t s[4];
+
+			Xoshiro256() {
+				// random_device is only hit once per thread. Mix in the thread id + clock in case it's deterministic on this platform
+				std::random_device rd;
+				uint64_t           seed = (static_cast<uint64_t>(rd()) << 32) ^ rd();
+				seed ^= std::hash<std::thread::id>{}(std::this_thread::get_id());
+				seed ^= static_cast<uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+
+				for (auto &word : s)
+					word = splitMix64(seed);
 			}
-		}
-	}
 
-	void FindPngImages(const fs::path &directory, std::vector<ImageInfo> &image_info) {
-		for (const auto &entry : fs::recursive_directory_iterator(directory)) {
-			if (entry.is_regular_file() && entry.path().extension() == ".png") {
-				fs::path    filepath = entry.path();
-				std::string filename = filepath.stem().string();
-				image_info.emplace_back(filename, filepath);
+			uint64_t next() {
+				const uint64_t result = rotl(s[1] * 5, 7) * 9;
+				const uint64_t t      = s[1] << 17;
+
+				s[2] ^= s[0];
+				s[3] ^= s[1];
+				s[1] ^= s[2];
+				s[0] ^= s[3];
+				s[2] ^= t;
+				s[3] = rotl(s[3], 45);
+				return result;
 			}
+		};
+
+		thread_local Xoshiro256 t_rng;
+
+		// Lemire's multiply-shift range reduction. Bias is at most bound / 2^32, which is negligible for alphabets
+		uint32_t reduce(uint32_t x, uint32_t bound) { return static_cast<uint32_t>((static_cast<uint64_t>(x) * bound) >> 32); }
+	} // namespace
+
+	uint64_t next() { return t_rng.next(); }
+
+	uint32_t nextBelow(uint32_t bound) { return bound == 0 ? 0 : reduce(static_cast<uint32_t>(t_rng.next() >> 32), bound); }
+
+	void fillString(char *out, size_t length, std::string_view alphabet) { fillStrings(out, 1, length, alphabet); }
+
+	void fillStrings(char *out, size_t count, size_t length, std::string_view alphabet) {
+		if (alphabet.empty()) {
+			LOGERROR("Random::fillStrings called with an empty alphabet");
+			return;
 		}
-	}
 
-	void FindPngImages(const fs::path &directory, std::map<std::string, ImageInfo> &image_info_map) {
-		for (const auto &entry : fs::recursive_directory_iterator(directory)) {
-			if (entry.is_regular_file() && entry.path().extension() == ".png") {
-				fs::path    filepath     = entry.path();
-				std::string filename     = filepath.stem().string();
-				image_info_map[filename] = {filename, filepath};
-			}
+		const auto  bound = static_cast<uint32_t>(alphabet.size());
+		const char *chars = alphabet.data();
+		Xoshiro256 &rng   = t_rng;
+
+		// every 64-bit draw yields two characters
+		size_t total = count * length;
+		while (total >= 2) {
+			const uint64_t r = rng.next();
+			*out++           = chars[reduce(static_cast<uint32_t>(r), bound)];
+			*out++           = chars[reduce(static_cast<uint32_t>(r >> 32), bound)];
+			total -= 2;
 		}
+		if (total)
+			*out = chars[reduce(static_cast<uint32_t>(rng.next() >> 32), bound)];
 	}
 
-	void OpenFolder(const fs::path &folderPath) {
-		if (fs::exists(folderPath))
-			ShellExecute(NULL, L"open", folderPath.c_str(), NULL, NULL, SW_SHOWNORMAL);
-		else
-			LOGERROR("Folder path does not exist: {}", folderPath.string());
+	std::string genString(size_t length, std::string_view alphabet) {
+		std::string str(length, '\0');
+		fillString(str.data(), length, alphabet);
+		return str;
 	}
 
-	void FilterLinesInFile(const fs::path &filePath, const std::string &startString) {
-		std::fstream file(filePath, std::ios::in | std::ios::out);
-
-		if (!file.is_open()) {
-			LOGERROR("Unable to open file {}", filePath.string());
-			return;
-		}
+	std::vector<std::string> genStrings(size_t count, size_t length, std::string_view alphabet) {
+		// generate everything in one pass, then slice
+		std::string buffer(count * length, '\0');
+		fillStrings(buffer.data(), count, length, alphabet);
 
-		std::string   line;
-		std::ofstream tempFile("temp.txt"); // temp file to store filtered lines
+		std::vector<std::string> strings;
+		strings.reserve(count);
+		for (size_t i = 0; i < count; ++i)
+			strings.emplace_back(buffer.data() + i * length, length);
+		return strings;
+	}
 
-		if (!tempFile.is_open()) {
-			LOGERROR("Unable to create temporary file");
-			return;
+	// UniqueIdSession
+	UniqueIdSession::UniqueIdSession(size_t length, std::string_view alphabet) : m_length(length) {
+		// repeated characters don't add possible IDs, and counting them would overstate the capacity (next() would then spin forever
+		// looking for an unused ID once the real ones run out)
+		std::array<bool, 256> seen{};
+		for (char c : alphabet) {
+			if (!std::exchange(seen[static_cast<unsigned char>(c)], true))
+				m_alphabet += c;
 		}
 
-		while (std::getline(file, line)) {
-			if (line.substr(0, startString.length()) == startString) {
-				tempFile << line << '\n'; // write the line to temp file if it starts with the given string
+		m_capacity = 1;
+		for (size_t i = 0; i < m_length; ++i) {
+			if (m_capacity > SIZE_MAX / std::max<size_t>(m_alphabet.size(), 1)) {
+				m_capacity = SIZE_MAX;
+				break;
 			}
+			m_capacity *= m_alphabet.size();
 		}
+	}
+
+	std::optional<std::string> UniqueIdSession::next() {
+		std::lock_guard<std::mutex> lock(m_mutex);
 
-		file.close();
-		tempFile.close();
+		if (m_alphabet.empty() || m_issued.size() >= m_capacity) {
+			LOGERROR("UniqueIdSession is out of unique IDs ({} issued)", m_issued.size());
+			return std::nullopt;
+		}
 
-		// replace original file with the temp file
-		fs::remove(filePath);             // remove original file
-		fs::rename("temp.txt", filePath); // rename temp file to original file
+		std::string id(m_length, '\0');
+		do {
+			fillString(id.data(), m_length, m_alphabet);
+		} while (m_issued.contains(id));
 
-		LOG("Filtered lines saved to {}", filePath.string());
+		m_issued.insert(id);
+		return id;
 	}
 
-	std::string get_text_content(const fs::path &file_path) {
-		if (!fs::exists(file_path)) {
-			LOG("[ERROR] File doesn't exist: '{}'", file_path.string());
-			return std::string();
+	std::vector<std::string> UniqueIdSession::next(size_t count) {
+		std::vector<std::string> ids;
+		ids.reserve(count);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (m_alphabet.empty() || m_capacity - m_issued.size() < count) {
+			LOGERROR("UniqueIdSession can't issue {} more unique IDs ({} issued)", count, m_issued.size());
+			return ids;
 		}
 
-		std::ifstream     Temp(file_path);
-		std::stringstream Buffer;
-		Buffer << Temp.rdbuf();
-		return Buffer.str();
+		m_issued.reserve(m_issued.size() + count);
+
+		// generate the whole batch at once, then only redraw the (rare) collisions
+		std::string buffer(count * m_length, '\0');
+		fillStrings(buffer.data(), count, m_length, m_alphabet);
+
+		for (size_t i = 0; i < count; ++i) {
+			std::string id(buffer.data() + i * m_length, m_length);
+			while (!m_issued.insert(id).second)
+				fillString(id.data(), m_length, m_alphabet);
+			ids.push_back(std::move(id));
+		}
+		return ids;
 	}
 
-#ifndef NO_JSON
+	bool UniqueIdSession::release(const std::string &id) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_issued.erase(id) > 0;
+	}
 
-	json get_json(const fs::path &file_path) {
-		json j;
+	void UniqueIdSession::clear() {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_issued.clear();
+	}
 
-		if (!fs::exists(file_path)) {
-			LOG("[ERROR] File doesn't exist: '{}'", file_path.string());
-			return j;
+	size_t UniqueIdSession::size() {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_issued.size();
+	}
+} // namespace Random
+
+namespace JsonBind {
+	std::string_view describe(Errc code) {
+		switch (code) {
+		case Errc::None:
+			return "no error";
+		case Errc::UnexpectedEnd:
+			return "unexpected end of input";
+		case Errc::Syntax:
+			return "syntax error";
+		case Errc::TypeMismatch:
+			return "value has the wrong type";
+		case Errc::OutOfRange:
+			return "number out of range";
+		case Errc::MissingField:
+			return "required field missing";
+		case Errc::TooDeep:
+			return "nested too deeply";
+		case Errc::TrailingData:
+			return "unexpected data after the value";
+		case Errc::Unreadable:
+			return "input couldn't be read";
 		}
+		return "unknown error";
+	}
 
-		try {
-			std::ifstream file(file_path);
-			file >> j;
-		} catch (const std::exception &e) {
-			LOG("[ERROR] Unable to read '{}': {}", file_path.filename().string(), e.what());
+	bool Reader::Fail(Errc code) {
+		if (!m_error)
+			m_error = {code, static_cast<size_t>(m_pos - m_begin)};
+		return false;
+	}
+
+	Reader::Token Reader::Peek() {
+		while (m_pos < m_end && (*m_pos == ' ' || *m_pos == '\t' || *m_pos == '\n' || *m_pos == '\r'))
+			++m_pos;
+		if (m_pos == m_end)
+			return Token::End;
+
+		switch (*m_pos) {
+		case '{':
+			return Token::Object;
+		case '[':
+			return Token::Array;
+		case '"':
+			return Token::String;
+		case 't':
+		case 'f':
+			return Token::Bool;
+		case 'n':
+			return Token::Null;
+		default:
+			return (*m_pos == '-' || (*m_pos >= '0' && *m_pos <= '9')) ? Token::Number : Token::Invalid;
 		}
+	}
 
-		return j;
+	bool Reader::Expect(char c) {
+		if (m_error)
+			return false;
+		if (Peek() == Token::End)
+			return Fail(Errc::UnexpectedEnd);
+		if (*m_pos != c)
+			return Fail(Errc::Syntax);
+		++m_pos;
+		return true;
 	}
 
-	bool write_json(const fs::path &file_path, const json &j) {
-		try {
-			std::ofstream file(file_path);
+	namespace {
+		// wrong token for what was asked: a syntax error if it isn't a value at all
+		Errc mismatch(Reader::Token token) {
+			return token == Reader::Token::End ? Errc::UnexpectedEnd : token == Reader::Token::Invalid ? Errc::Syntax : Errc::TypeMismatch;
+		}
 
-			if (file.is_open()) {
-				file << j.dump(4); // pretty-print with 4 spaces indentation
-				file.close();
-			} else {
-				LOG("[ERROR] Couldn't open file for writing: {}", file_path.string());
+		bool matchLiteral(const char *&pos, const char *end, std::string_view literal) {
+			if (static_cast<size_t>(end - pos) < literal.size() || std::string_view(pos, literal.size()) != literal)
 				return false;
+			pos += literal.size();
+			return true;
+		}
+
+		void appendUtf8(std::string &out, uint32_t codePoint) {
+			if (codePoint < 0x80) {
+				out += static_cast<char>(codePoint);
+			} else if (codePoint < 0x800) {
+				out += static_cast<char>(0xC0 | codePoint >> 6);
+				out += static_cast<char>(0x80 | (codePoint & 0x3F));
+			} else if (codePoint < 0x10000) {
+				out += static_cast<char>(0xE0 | codePoint >> 12);
+				out += static_cast<char>(0x80 | (codePoint >> 6 & 0x3F));
+				out += static_cast<char>(0x80 | (codePoint & 0x3F));
+			} else {
+				out += static_cast<char>(0xF0 | codePoint >> 18);
+				out += static_cast<char>(0x80 | (codePoint >> 12 & 0x3F));
+				out += static_cast<char>(0x80 | (codePoint >> 6 & 0x3F));
+				out += static_cast<char>(0x80 | (codePoint & 0x3F));
 			}
+		}
 
+		bool readHex4(const char *&pos, const char *end, uint32_t &value) {
+			if (end - pos < 4)
+				return false;
+			const auto [ptr, ec] = std::from_chars(pos, pos + 4, value, 16);
+			if (ec != std::errc() || ptr != pos + 4)
+				return false;
+			pos += 4;
 			return true;
-		} catch (const std::exception &e) {
-			LOG("[ERROR] Unable to write to '{}': {}", file_path.filename().string(), e.what());
-			return false;
 		}
+	} // namespace
+
+	bool Reader::ReadNull() {
+		if (const Token token = Peek(); token != Token::Null)
+			return Fail(mismatch(token));
+		return matchLiteral(m_pos, m_end, "null") || Fail(Errc::Syntax);
 	}
-#endif
 
-	void appendLineIfNotExist(const fs::path &file, const std::string &line) {
-		const std::string        fileName = file.filename().string();
-		std::vector<std::string> lines;
+	bool Reader::ReadBool(bool &value) {
+		if (const Token token = Peek(); token != Token::Bool)
+			return Fail(mismatch(token));
 
-		// Read file if it exists
-		if (fs::exists(file)) {
-			std::ifstream in(file);
-			std::string   existingLine;
-			while (std::getline(in, existingLine)) {
-				// normalize whitespace and case if you want
-				if (existingLine == line) {
-					LOG("{} already contains line: \"{}\"", fileName, line);
-					return; // bail out if found
-				}
-				lines.push_back(existingLine);
-			}
-			in.close();
-		} else
-			LOG("WARNING: File doesn't exist: \"{}\"", file.string());
+		value = *m_pos == 't';
+		return matchLiteral(m_pos, m_end, value ? "true" : "false") || Fail(Errc::Syntax);
+	}
 
-		// Add line
-		lines.push_back(line);
+	bool Reader::ReadNumberText(std::string_view &text, bool &integral) {
+		if (m_error)
+			return false;
+		if (const Token token = Peek(); token != Token::Number)
+			return Fail(mismatch(token));
+
+		// validates the JSON number grammar, which is stricter than from_chars
+		const char *start  = m_pos;
+		const auto  digits = [&] {
+			const char *first = m_pos;
+			while (m_pos < m_end && *m_pos >= '0' && *m_pos <= '9')
+				++m_pos;
+			return m_pos - first;
+		};
 
-		// Write back the file
-		{
-			std::ofstream out(file, std::ios::trunc);
-			for (auto &line : lines)
-				out << line << "\n";
+		if (*m_pos == '-')
+			++m_pos;
+		const char *intStart  = m_pos;
+		const auto  intDigits = digits();
+		if (intDigits == 0 || (intDigits > 1 && *intStart == '0'))
+			return Fail(Errc::Syntax);
+
+		integral = true;
+		if (m_pos < m_end && *m_pos == '.') {
+			++m_pos;
+			integral = false;
+			if (digits() == 0)
+				return Fail(Errc::Syntax);
+		}
+		if (m_pos < m_end && (*m_pos == 'e' || *m_pos == 'E')) {
+			++m_pos;
+			integral = false;
+			if (m_pos < m_end && (*m_pos == '+' || *m_pos == '-'))
+				++m_pos;
+			if (digits() == 0)
+				return Fail(Errc::Syntax);
 		}
 
-		LOG("Added line to {}: \"{}\"", fileName, line);
+		text = std::string_view(start, m_pos - start);
+		return true;
 	}
-} // namespace Files
-
-#if !defined(NO_JSON) && !defined(NO_BAKKESMOD)
-namespace PluginUpdates {
-	// global state for all the PluginUpdates:: functions. Can turn all this into a class maybe ong frfr
-	PluginUpdaterInfo pluginUpdaterInfo;
-	PluginUpdateInfo  updateInfo;
-	std::mutex        updateMutex;
-
-	/*
-	    - Will populate updateInfo with the necessary data
-	    - This update check only works if the github release name contains the version number. Like: "v1.2.3" or "Custom Thing v2.1.4" etc.
-	*/
-	void checkForUpdates(const std::string &modName, const std::string &currentVersion, const std::string &assetName) {
-		CurlRequest       req;
-		const std::string repoName = getRepoName(modName);
-		req.url                    = std::format("https://api.github.com/repos/smallest-cock/{}/releases/latest", repoName);
-		LOG("Checking for updates using this URL: {}", req.url);
-		HttpWrapper::SendCurlRequest(req, [modName, currentVersion, assetName](int code, std::string result) {
-			if (code != 200) {
-				LOGERROR("Invalid HTTP code: {}. Update check failed!", code);
-				return;
-			}
-
-			auto responseJsonOpt = Helper::getJsonFromStr(result);
-			if (!responseJsonOpt)
-				return;
 
-			std::string assetFileName = (assetName.empty() ? modName : assetName) + ".zip";
-			auto        updateInfoOpt = getUpdateInfo(*responseJsonOpt, assetFileName);
-			if (!updateInfoOpt)
-				return;
+	bool Reader::ReadInt(int64_t &value) {
+		std::string_view text;
+		bool             integral = false;
+		if (!ReadNumberText(text, integral))
+			return false;
+		if (!integral) {
+			m_pos = text.data();
+			return Fail(Errc::TypeMismatch);
+		}
 
-			PluginUpdateInfo &info = *updateInfoOpt;
-			info.pluginName        = modName;
-			info.outOfDate         = currentVersion != info.latestVersion;
+		const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+		return ec == std::errc() || (m_pos = text.data(), Fail(Errc::OutOfRange));
+	}
 
-			{
-				std::lock_guard<std::mutex> lock(updateMutex);
-				updateInfo = info;
-			}
+	bool Reader::ReadUInt(uint64_t &value) {
+		std::string_view text;
+		bool             integral = false;
+		if (!ReadNumberText(text, integral))
+			return false;
+		if (!integral) {
+			m_pos = text.data();
+			return Fail(Errc::TypeMismatch);
+		}
+		if (text.front() == '-') {
+			m_pos = text.data();
+			return Fail(text == "-0" ? Errc::TypeMismatch : Errc::OutOfRange);
+		}
 
-			if (info.outOfDate)
-				LOG("New version available: {}", info.latestVersion);
-			else
-				LOG("Plugin is up to date: {}", currentVersion);
-		});
+		const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+		return ec == std::errc() || (m_pos = text.data(), Fail(Errc::OutOfRange));
 	}
 
-	std::string getRepoName(const std::string &modName) {
-		// handle edge case bc CBO repo name isnt PascalCase like the other plugin repos
-		// ... and I dont know what side effects changing the repo name would have, smh bitch
-		if (modName == "CustomBallOnline")
-			return "Custom-Ball-Online";
+	bool Reader::ReadDouble(double &value) {
+		std::string_view text;
+		bool             integral = false;
+		if (!ReadNumberText(text, integral))
+			return false;
 
-		return modName;
+		const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+		return ec == std::errc() || (m_pos = text.data(), Fail(Errc::OutOfRange));
 	}
 
-	// the high level plugin-facing function
-	void installUpdate(const std::shared_ptr<GameWrapper> &gw) {
-		const std::string updateCmd = pluginUpdaterInfo.makeUpdateCmd(updateInfo);
+	bool Reader::ReadStringInto(std::string_view &view, std::string &scratch) {
+		if (m_error)
+			return false;
+		if (const Token token = Peek(); token != Token::String)
+			return Fail(mismatch(token));
+		++m_pos;
+
+		// the common case has no escapes and is returned as a view, anything else is decoded into scratch
+		const char *start = m_pos;
+		while (m_pos < m_end && *m_pos != '"' && *m_pos != '\\') {
+			if (static_cast<unsigned char>(*m_pos) < 0x20)
+				return Fail(Errc::Syntax);
+			++m_pos;
+		}
+		if (m_pos == m_end)
+			return Fail(Errc::UnexpectedEnd);
+		if (*m_pos == '"') {
+			view = std::string_view(start, m_pos++ - start);
+			return true;
+		}
 
-		// check if PluginUpdater's cvar exists (aka if the plugin is loaded)
-		if (_globalCvarManager->getCvar(pluginUpdaterInfo.existenceCheckCvar))
+		scratch.assign(start, m_pos);
+		while (true) {
+			if (m_pos == m_end)
+				return Fail(Errc::UnexpectedEnd);
+
+			const char c = *m_pos++;
+			if (c == '"')
+				break;
+			if (static_cast<unsigned char>(c) < 0x20) {
+				--m_pos;
+				return Fail(Errc::Syntax);
+			}
+			if (c != '\\') {
+				scratch += c;
+				continue;
+			}
+
+			if (m_pos == m_end)
+				return Fail(Errc::UnexpectedEnd);
+			switch (const char escape = *m_pos++) {
+			case '"':
+			case '\\':
+			case '/':
+				scratch += escape;
+				break;
+			case 'b':
+				scratch += '\b';
+				break;
+			case 'f':
+				scratch += '\f';
+				break;
+			case 'n':
+				scratch += '\n';
+				break;
+			case 'r':
+				scratch += '\r';
+				break;
+			case 't':
+				scratch += '\t';
+				break;
+			case 'u': {
+				uint32_t codePoint = 0;
+				if (!readHex4(m_pos, m_end, codePoint))
+					return Fail(Errc::Syntax);
+
+				// a high surrogate has to be followed by an escaped low one
+				if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+					uint32_t low = 0;
+					if (!matchLiteral(m_pos, m_end, "\\u") || !readHex4(m_pos, m_end, low) || low < 0xDC00 || low > 0xDFFF)
+						return Fail(Errc::Syntax);
+					codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+				} else if (codePoint >= 0xDC00 && codePoint <= 0xDFFF) {
+					return Fail(Errc::Syntax);
+				}
+				appendUtf8(scratch, codePoint);
+				break;
+			}
+			default:
+				--m_pos;
+				return Fail(Errc::Syntax);
+			}
+		}
+
+		view = scratch;
+		return true;
+	}
+
+	bool Reader::ReadString(std::string &value) {
+		std::string_view view;
+		if (!ReadStringInto(view, value))
+			return false;
+		if (view.data() != value.data())
+			value.assign(view);
+		return true;
+	}
+
+	bool Reader::BeginObject() {
+		if (m_error)
+			return false;
+		if (const Token token = Peek(); token != Token::Object)
+			return Fail(mismatch(token));
+		if (++m_depth > maxDepth)
+			return Fail(Errc::TooDeep);
+		++m_pos;
+		return true;
+	}
+
+	bool Reader::NextKey(bool &first, std::string_view &key, std::string &scratch) {
+		if (m_error)
+			return false;
+		if (Peek() == Token::End)
+			return Fail(Errc::UnexpectedEnd);
+		if (*m_pos == '}') { // a trailing comma fails as a missing key instead
+			++m_pos;
+			--m_depth;
+			return false;
+		}
+		if (!first && !Expect(','))
+			return false;
+		first = false;
+		return ReadStringInto(key, scratch) && Expect(':');
+	}
+
+	bool Reader::BeginArray() {
+		if (m_error)
+			return false;
+		if (const Token token = Peek(); token != Token::Array)
+			return Fail(mismatch(token));
+		if (++m_depth > maxDepth)
+			return Fail(Errc::TooDeep);
+		++m_pos;
+		return true;
+	}
+
+	bool Reader::NextElement(bool &first) {
+		if (m_error)
+			return false;
+		if (Peek() == Token::End)
+			return Fail(Errc::UnexpectedEnd);
+		if (*m_pos == ']') {
+			++m_pos;
+			--m_depth;
+			return false;
+		}
+		if (!first && !Expect(','))
+			return false;
+		first = false;
+		return true;
+	}
+
+	bool Reader::Skip() {
+		std::string      scratch;
+		std::string_view view;
+		bool             first = true;
+		switch (const Token token = Peek()) {
+		case Token::Object:
+			if (!BeginObject())
+				return false;
+			while (NextKey(first, view, scratch)) {
+				if (!Skip())
+					return false;
+			}
+			return !m_error;
+		case Token::Array:
+			if (!BeginArray())
+				return false;
+			while (NextElement(first)) {
+				if (!Skip())
+					return false;
+			}
+			return !m_error;
+		case Token::String:
+			return ReadStringInto(view, scratch);
+		case Token::Number: {
+			bool integral = false;
+			return ReadNumberText(view, integral);
+		}
+		case Token::Bool: {
+			bool value = false;
+			return ReadBool(value);
+		}
+		case Token::Null:
+			return ReadNull();
+		default:
+			return Fail(mismatch(token));
+		}
+	}
+
+	bool Reader::Finish() {
+		if (m_error)
+			return false;
+		return Peek() == Token::End || Fail(Errc::TrailingData);
+	}
+} // namespace JsonBind
+
+namespace Helper {
+#ifndef NO_JSON
+	std::optional<json> getJsonFromStr(const std::string &str) {
+		try {
+			return json::parse(str);
+		} catch (...) {
+			LOGERROR("Unable to parse JSON!");
+			return std::nullopt;
+		}
+	}
+#endif
+
+	void parallelFor(size_t count, size_t minChunk, const std::function<void(size_t begin, size_t end)> &fn, size_t numThreads) {
+		if (count == 0)
+			return;
+
+		if (numThreads == 0)
+			numThreads = std::max(1u, std::thread::hardware_concurrency());
+		numThreads = std::clamp<size_t>(count / std::max<size_t>(minChunk, 1), 1, numThreads);
+
+		if (numThreads == 1) {
+			fn(0, count);
+			return;
+		}
+
+		// the caller takes the first chunk instead of idling
+		const size_t             chunk = (count + numThreads - 1) / numThreads;
+		std::vector<std::thread> workers;
+		workers.reserve(numThreads - 1);
+		for (size_t begin = chunk; begin < count; begin += chunk)
+			workers.emplace_back(fn, begin, std::min(begin + chunk, count));
+
+		fn(0, std::min(chunk, count));
+
+		for (auto &worker : workers)
+			worker.join();
+	}
+} // namespace Helper
+
+namespace Files {
+	namespace {
+		// Path-keyed LRU map that keeps the process-wide caches below bounded over a long session. Not thread-safe, callers lock
+		template <typename Value>
+		class LruCache {
+			using Key   = fs::path::string_type;
+			using Entry = std::pair<Key, Value>;
+
+			std::list<Entry>                                             m_entries; // most recently used first
+			std::unordered_map<Key, typename std::list<Entry>::iterator> m_index;
+			size_t                                                       m_capacity;
+
+		public:
+			explicit LruCache(size_t capacity) : m_capacity(std::max<size_t>(capacity, 1)) {}
+
+			Value *Find(const Key &key) {
+				auto it = m_index.find(key);
+				if (it == m_index.end())
+					return nullptr;
+				m_entries.splice(m_entries.begin(), m_entries, it->second);
+				return &it->second->second;
+			}
+
+			// inserts a default Value if missing, evicting the least recently used entry when full
+			Value &GetOrCreate(const Key &key) {
+				if (Value *value = Find(key))
+					return *value;
+
+				if (m_entries.size() >= m_capacity) {
+					m_index.erase(m_entries.back().first);
+					m_entries.pop_back();
+				}
+				m_entries.emplace_front(key, Value{});
+				m_index.emplace(key, m_entries.begin());
+				return m_entries.front().second;
+			}
+
+			void Erase(const Key &key) {
+				auto it = m_index.find(key);
+				if (it == m_index.end())
+					return;
+				m_entries.erase(it->second);
+				m_index.erase(it);
+			}
+
+			void Clear() {
+				m_entries.clear();
+				m_index.clear();
+			}
+		};
+
+		struct DirectoryListing {
+			enum class Kind : uint8_t {
+				Directory,
+				Image, // one of acceptableFormats, in any case
+				Png    // exactly ".png"
+			};
+
+			struct Child {
+				fs::path path;
+				Kind     kind;
+			};
+
+			fs::file_time_type writeTime;
+			bool               trusted = false; // writeTime was old enough when listed that a later change must move it
+			std::vector<Child> children;        // subdirectories and images, in iteration order
+		};
+
+		// a listing is a path per subdirectory/image, so a few thousand directories stay in the low MBs even for big folders
+		constexpr size_t imageScanCacheSize = 4096;
+
+		std::mutex                                        imageScanMutex;
+		LruCache<std::shared_ptr<const DirectoryListing>> imageScanCache{imageScanCacheSize};
+
+		// compares the extension in place, no lowercased copies
+		std::optional<DirectoryListing::Kind> imageKind(const fs::path::string_type &filename) {
+			const size_t dot = filename.find_last_of('.');
+			if (dot == fs::path::string_type::npos || dot == 0)
+				return std::nullopt;
+
+			const size_t extensionLength = filename.size() - dot;
+			for (std::string_view format : acceptableFormats) {
+				if (format.size() != extensionLength)
+					continue;
+
+				bool exact = true, folded = true;
+				for (size_t i = 0; i < extensionLength && folded; ++i) {
+					const auto c = static_cast<std::make_unsigned_t<fs::path::value_type>>(filename[dot + i]);
+					exact &= c == static_cast<unsigned char>(format[i]);
+					folded = exact || (c < 0x80 && std::tolower(c) == format[i]);
+				}
+
+				if (folded)
+					return exact && format == ".png" ? DirectoryListing::Kind::Png : DirectoryListing::Kind::Image;
+			}
+			return std::nullopt;
+		}
+
+		std::shared_ptr<const DirectoryListing> listDirectory(const fs::path &directory) {
+			std::error_code          ec;
+			const fs::file_time_type writeTime = fs::last_write_time(directory, ec);
+			if (ec) {
+				// gone (or unreadable), so whatever was cached for it is dead weight
+				std::lock_guard lock(imageScanMutex);
+				imageScanCache.Erase(directory.native());
+				return nullptr;
+			}
+
+			{
+				std::lock_guard lock(imageScanMutex);
+				auto           *cached = imageScanCache.Find(directory.native());
+				if (cached && (*cached)->trusted && (*cached)->writeTime == writeTime)
+					return *cached;
+			}
+
+			auto listing       = std::make_shared<DirectoryListing>();
+			listing->writeTime = writeTime;
+			// timestamps are coarse on some file systems, so a listing taken right after a change could miss a second change that
+			// lands on the same timestamp. Those get listed again next time instead of being trusted
+			listing->trusted = fs::file_time_type::clock::now() - writeTime > std::chrono::seconds(2);
+
+			// directory_entry caches the type from the directory read itself, so this doesn't stat every file
+			for (auto it = fs::directory_iterator(directory, fs::directory_options::skip_permission_denied, ec);
+			     !ec && it != fs::directory_iterator();
+			     it.increment(ec)) {
+				const fs::directory_entry &entry = *it;
+				std::error_code            typeEc;
+
+				if (entry.is_directory(typeEc) && !entry.is_symlink(typeEc)) // recursive_directory_iterator doesn't follow these either
+					listing->children.push_back({entry.path(), DirectoryListing::Kind::Directory});
+				else if (entry.is_regular_file(typeEc)) {
+					if (auto kind = imageKind(entry.path().filename().native()))
+						listing->children.push_back({entry.path(), *kind});
+				}
+			}
+
+			// a listing cut short by an error is still returned, but never cached, or it'd be served until the directory changes
+			if (ec) {
+				LOGERROR("Unable to list '{}': {}", directory.string(), ec.message());
+				return listing;
+			}
+
+			std::lock_guard lock(imageScanMutex);
+			imageScanCache.GetOrCreate(directory.native()) = listing;
+			return listing;
+		}
+
+		// Position of the first '\n' in [p, end), or end
+		const char *findNewline(const char *p, const char *end) {
+#ifdef MODUTILS_AVX2
+			const __m256i newline = _mm256_set1_epi8('\n');
+			for (; end - p >= 32; p += 32) {
+				const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+				if (const auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, newline))))
+					return p + std::countr_zero(mask);
+			}
+#elif defined(MODUTILS_SSE2)
+			const __m128i newline = _mm_set1_epi8('\n');
+			for (; end - p >= 16; p += 16) {
+				const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+				if (const auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, newline))))
+					return p + std::countr_zero(mask);
+			}
+#endif
+			for (; p < end; ++p) {
+				if (*p == '\n')
+					return p;
+			}
+			return end;
+		}
+
+		// Appends the offset (from base) of every '\n' in [base + begin, base + end)
+		void collectNewlines(const char *base, size_t begin, size_t end, std::vector<size_t> &out) {
+			const char *p    = base + begin;
+			const char *stop = base + end;
+#ifdef MODUTILS_AVX2
+			const __m256i newline = _mm256_set1_epi8('\n');
+			for (; stop - p >= 32; p += 32) {
+				const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+				for (auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, newline))); mask; mask &= mask - 1)
+					out.push_back(p - base + std::countr_zero(mask));
+			}
+#elif defined(MODUTILS_SSE2)
+			const __m128i newline = _mm_set1_epi8('\n');
+			for (; stop - p >= 16; p += 16) {
+				const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+				for (auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, newline))); mask; mask &= mask - 1)
+					out.push_back(p - base + std::countr_zero(mask));
+			}
+#endif
+			for (; p < stop; ++p) {
+				if (*p == '\n')
+					out.push_back(p - base);
+			}
+		}
+
+		// Position of the first byte equal to a or b in [p, end), or end
+		const char *findEither(const char *p, const char *end, char a, char b) {
+#ifdef MODUTILS_AVX2
+			const __m256i va = _mm256_set1_epi8(a), vb = _mm256_set1_epi8(b);
+			for (; end - p >= 32; p += 32) {
+				const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+				const __m256i hits  = _mm256_or_si256(_mm256_cmpeq_epi8(block, va), _mm256_cmpeq_epi8(block, vb));
+				if (const auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(hits)))
+					return p + std::countr_zero(mask);
+			}
+#elif defined(MODUTILS_SSE2)
+			const __m128i va = _mm_set1_epi8(a), vb = _mm_set1_epi8(b);
+			for (; end - p >= 16; p += 16) {
+				const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+				const __m128i hits  = _mm_or_si128(_mm_cmpeq_epi8(block, va), _mm_cmpeq_epi8(block, vb));
+				if (const auto mask = static_cast<uint32_t>(_mm_movemask_epi8(hits)))
+					return p + std::countr_zero(mask);
+			}
+#endif
+			for (; p < end; ++p) {
+				if (*p == a || *p == b)
+					return p;
+			}
+			return end;
+		}
+
+		// First match of term in [p, end), or nullptr. With ignoreCase, term must already be lowercase and bytes are compared the way
+		// Format::iContains compares them
+		const char *findTerm(const char *p, const char *end, std::string_view term, bool ignoreCase) {
+			if (term.empty())
+				return p;
+			if (static_cast<size_t>(end - p) < term.size())
+				return nullptr;
+
+			const char  first      = term[0];
+			const char  firstUpper = ignoreCase ? static_cast<char>(std::toupper(static_cast<unsigned char>(first))) : first;
+			const char *lastStart  = end - term.size() + 1;
+			for (; (p = findEither(p, lastStart, first, firstUpper)) < lastStart; ++p) {
+				if (!ignoreCase) {
+					if (std::memcmp(p + 1, term.data() + 1, term.size() - 1) == 0)
+						return p;
+					continue;
+				}
+
+				size_t i = 1;
+				while (i < term.size() && std::tolower(static_cast<unsigned char>(p[i])) == static_cast<unsigned char>(term[i]))
+					++i;
+				if (i == term.size())
+					return p;
+			}
+			return nullptr;
+		}
+
+		// Writes a file through a temp file next to it (unique per writer, so concurrent writers never share one) that only
+		// replaces the target on Commit, so a crash leaves either the old or the new contents. Small writes are staged in a buffer
+		class AtomicFileWriter {
+			fs::path    m_file;
+			fs::path    m_tempFile;
+			std::string m_buffer;
+			bool        m_ok = true;
+#ifdef _WIN32
+			HANDLE m_handle = INVALID_HANDLE_VALUE;
+#else
+			int m_fd = -1;
+#endif
+
+			void WriteRaw(std::string_view data) {
+#ifdef _WIN32
+				for (size_t written = 0; m_ok && written < data.size();) {
+					DWORD       chunk   = 0;
+					const DWORD toWrite = static_cast<DWORD>(std::min<size_t>(data.size() - written, 1u << 30));
+					m_ok                = WriteFile(m_handle, data.data() + written, toWrite, &chunk, nullptr) && chunk > 0;
+					written += chunk;
+				}
+#else
+				for (size_t written = 0; m_ok && written < data.size();) {
+					const ssize_t chunk = ::write(m_fd, data.data() + written, data.size() - written);
+					m_ok                = chunk > 0;
+					written += m_ok ? static_cast<size_t>(chunk) : 0;
+				}
+#endif
+			}
+
+			void FlushBuffer() {
+				WriteRaw(m_buffer);
+				m_buffer.clear();
+			}
+
+		public:
+			static constexpr size_t bufferSize = 1 << 20;
+
+			explicit AtomicFileWriter(const fs::path &file) : m_file(file), m_tempFile(file) {
+				m_tempFile += "." + Random::genString(8, Random::hexLower) + ".tmp";
+#ifdef _WIN32
+				m_handle = CreateFileW(m_tempFile.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_NEW, FILE_ATTRIBUTE_NORMAL, nullptr);
+				m_ok     = m_handle != INVALID_HANDLE_VALUE;
+#else
+				m_fd = ::open(m_tempFile.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+				m_ok = m_fd >= 0;
+#endif
+				if (!m_ok)
+					LOGERROR("Unable to create temporary file '{}'", m_tempFile.string());
+			}
+
+			// discards the temp file unless it was committed
+			~AtomicFileWriter() {
+#ifdef _WIN32
+				if (m_handle == INVALID_HANDLE_VALUE)
+					return;
+				CloseHandle(m_handle);
+#else
+				if (m_fd < 0)
+					return;
+				::close(m_fd);
+#endif
+				std::error_code ec;
+				fs::remove(m_tempFile, ec);
+			}
+
+			AtomicFileWriter(const AtomicFileWriter &)            = delete;
+			AtomicFileWriter &operator=(const AtomicFileWriter &) = delete;
+
+			bool IsOpen() const { return m_ok; }
+
+			void Write(std::string_view data) {
+				if (!m_ok)
+					return;
+				if (m_buffer.size() + data.size() > bufferSize)
+					FlushBuffer();
+				if (data.size() >= bufferSize)
+					WriteRaw(data); // big enough to go straight out
+				else
+					m_buffer.append(data);
+			}
+
+			// flushes everything to disk and swaps the temp file in. On Windows nothing may still have the target mapped
+			bool Commit() {
+				if (m_ok)
+					FlushBuffer();
+
+#ifdef _WIN32
+				if (m_handle == INVALID_HANDLE_VALUE)
+					return false;
+
+				m_ok = m_ok && FlushFileBuffers(m_handle);
+				CloseHandle(std::exchange(m_handle, INVALID_HANDLE_VALUE));
+
+				// ReplaceFileW keeps the existing file's ACL and attributes, a plain move would leave the temp file's defaults. It's
+				// fussier about sharing, so a failed replace still falls back to the move
+				if (m_ok && GetFileAttributesW(m_file.c_str()) != INVALID_FILE_ATTRIBUTES &&
+				    ReplaceFileW(m_file.c_str(), m_tempFile.c_str(), nullptr, REPLACEFILE_IGNORE_MERGE_ERRORS, nullptr, nullptr))
+					return true;
+				m_ok = m_ok && MoveFileExW(m_tempFile.c_str(), m_file.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+				if (m_fd < 0)
+					return false;
+
+				// carry the replaced file's permissions over, instead of swapping in a 0644 temp file
+				struct stat target {};
+				if (m_ok && ::stat(m_file.c_str(), &target) == 0)
+					m_ok = ::fchmod(m_fd, target.st_mode & 07777) == 0;
+
+				m_ok = m_ok && ::fsync(m_fd) == 0;
+				m_ok = ::close(std::exchange(m_fd, -1)) == 0 && m_ok;
+
+				m_ok = m_ok && ::rename(m_tempFile.c_str(), m_file.c_str()) == 0;
+				if (m_ok) {
+					// make the rename itself durable
+					const fs::path directory = m_file.has_parent_path() ? m_file.parent_path() : fs::path(".");
+					const int      dirFd     = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+					if (dirFd >= 0) {
+						::fsync(dirFd);
+						::close(dirFd);
+					}
+				}
+#endif
+
+				if (!m_ok) {
+					std::error_code ec;
+					fs::remove(m_tempFile, ec);
+					LOGERROR("Unable to write '{}'", m_file.string());
+				}
+				return m_ok;
+			}
+		};
+	} // namespace
+
+	std::vector<fs::path> ScanImages(const fs::path &directory, bool pngOnly) {
+		std::unordered_map<fs::path::string_type, std::shared_ptr<const DirectoryListing>> listings;
+
+		// refresh the tree one level at a time, so every directory of a level can be listed in parallel
+		std::vector<fs::path> level{directory};
+		while (!level.empty()) {
+			std::vector<std::shared_ptr<const DirectoryListing>> levelListings(level.size());
+			Helper::parallelFor(level.size(), 16, [&](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; ++i)
+					levelListings[i] = listDirectory(level[i]);
+			});
+
+			std::vector<fs::path> nextLevel;
+			for (size_t i = 0; i < level.size(); ++i) {
+				if (!levelListings[i])
+					continue;
+
+				for (const auto &child : levelListings[i]->children) {
+					if (child.kind == DirectoryListing::Kind::Directory)
+						nextLevel.push_back(child.path);
+				}
+				listings.emplace(level[i].native(), std::move(levelListings[i]));
+			}
+			level = std::move(nextLevel);
+		}
+
+		std::vector<fs::path> images;
+		if (!listings.contains(directory.native())) {
+			LOGERROR("Unable to scan '{}' for images", directory.string());
+			return images;
+		}
+
+		// depth first, descending into each subdirectory where it was listed, same order as recursive_directory_iterator
+		std::function<void(const DirectoryListing &)> collect = [&](const DirectoryListing &listing) {
+			for (const auto &child : listing.children) {
+				if (child.kind == DirectoryListing::Kind::Directory) {
+					if (auto it = listings.find(child.path.native()); it != listings.end())
+						collect(*it->second);
+				} else if (!pngOnly || child.kind == DirectoryListing::Kind::Png) {
+					images.push_back(child.path);
+				}
+			}
+		};
+		collect(*listings.at(directory.native()));
+
+		return images;
+	}
+
+	void ClearImageScanCache() {
+		std::lock_guard lock(imageScanMutex);
+		imageScanCache.Clear();
+	}
+
+	namespace {
+		uint32_t readBE16(const uint8_t *p) { return (uint32_t(p[0]) << 8) | p[1]; }
+		uint32_t readBE32(const uint8_t *p) { return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3]; }
+		uint32_t readLE16(const uint8_t *p) { return uint32_t(p[0]) | (uint32_t(p[1]) << 8); }
+		uint32_t readLE32(const uint8_t *p) { return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24); }
+
+		std::optional<ImageMetadata> probePng(const uint8_t *header, size_t size) {
+			// signature, IHDR length + type, width, height, bit depth, color type
+			if (size < 26 || std::memcmp(header + 12, "IHDR", 4) != 0)
+				return std::nullopt;
+
+			static constexpr uint8_t channelsByColorType[7] = {1, 0, 3, 3, 2, 0, 4};
+			const uint8_t            colorType              = header[25];
+			if (colorType > 6 || channelsByColorType[colorType] == 0)
+				return std::nullopt;
+
+			return ImageMetadata{ImageFormat::Png, readBE32(header + 16), readBE32(header + 20), channelsByColorType[colorType], header[24]};
+		}
+
+		std::optional<ImageMetadata> probeBmp(const uint8_t *header, size_t size) {
+			if (size < 26)
+				return std::nullopt;
+
+			uint32_t       width, height, bitCount;
+			const uint32_t dibSize = readLE32(header + 14);
+			if (dibSize == 12) { // BITMAPCOREHEADER
+				width    = readLE16(header + 18);
+				height   = readLE16(header + 20);
+				bitCount = readLE16(header + 24);
+			} else if (dibSize >= 40 && size >= 30) {
+				width    = readLE32(header + 18);
+				height   = static_cast<uint32_t>(std::abs(static_cast<int32_t>(readLE32(header + 22)))); // negative = top-down rows
+				bitCount = readLE16(header + 28);
+			} else {
+				return std::nullopt;
+			}
+
+			switch (bitCount) {
+			case 32: return ImageMetadata{ImageFormat::Bmp, width, height, 4, 8};
+			case 24: return ImageMetadata{ImageFormat::Bmp, width, height, 3, 8};
+			case 16: return ImageMetadata{ImageFormat::Bmp, width, height, 3, 5};
+			case 8:
+			case 4:
+			case 1: return ImageMetadata{ImageFormat::Bmp, width, height, 3, static_cast<uint8_t>(bitCount)};
+			default: return std::nullopt;
+			}
+		}
+
+		// walks the marker segments up to the first start-of-frame, seeking over everything else (EXIF thumbnails included)
+		std::optional<ImageMetadata> probeJpeg(std::ifstream &file) {
+			file.seekg(2);
+			uint8_t segment[8];
+			while (file.read(reinterpret_cast<char *>(segment), 2)) {
+				if (segment[0] != 0xFF)
+					return std::nullopt;
+
+				uint8_t marker = segment[1];
+				while (marker == 0xFF) { // fill bytes
+					if (!file.read(reinterpret_cast<char *>(&marker), 1))
+						return std::nullopt;
+				}
+
+				if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) // no length field
+					continue;
+				if (marker == 0xD9 || marker == 0xDA) // end of image / start of scan before any frame header
+					return std::nullopt;
+
+				if (!file.read(reinterpret_cast<char *>(segment), 2))
+					return std::nullopt;
+				const uint32_t length = readBE16(segment);
+				if (length < 2)
+					return std::nullopt;
+
+				// SOF0-15, minus DHT (C4), JPG (C8) and DAC (CC)
+				const bool startOfFrame = marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+				if (startOfFrame) {
+					if (length < 8 || !file.read(reinterpret_cast<char *>(segment), 6))
+						return std::nullopt;
+					return ImageMetadata{ImageFormat::Jpeg, readBE16(segment + 3), readBE16(segment + 1), segment[5], segment[0]};
+				}
+
+				file.seekg(length - 2, std::ios::cur);
+			}
+			return std::nullopt;
+		}
+	} // namespace
+
+	std::optional<ImageMetadata> ProbeImage(const fs::path &file) {
+		std::ifstream in(file, std::ios::binary);
+		if (!in)
+			return std::nullopt;
+
+		uint8_t header[32]{};
+		in.read(reinterpret_cast<char *>(header), sizeof(header));
+		const size_t size = static_cast<size_t>(in.gcount());
+		in.clear();
+
+		static constexpr uint8_t pngSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+		if (size >= 8 && std::memcmp(header, pngSignature, 8) == 0)
+			return probePng(header, size);
+		if (size >= 3 && header[0] == 0xFF && header[1] == 0xD8 && header[2] == 0xFF)
+			return probeJpeg(in);
+		if (size >= 2 && header[0] == 'B' && header[1] == 'M')
+			return probeBmp(header, size);
+		return std::nullopt;
+	}
+
+	std::vector<std::optional<ImageMetadata>> ProbeImages(const std::vector<fs::path> &files) {
+		std::vector<std::optional<ImageMetadata>> results(files.size());
+		Helper::parallelFor(files.size(), 32, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i)
+				results[i] = ProbeImage(files[i]);
+		});
+		return results;
+	}
+
+	// ImageIndex class
+	namespace {
+		// "MUII" + format version, then per entry: u16 path length, UTF-8 path, u64 size, i64 write time, u8 format, u32 width,
+		// u32 height, u8 channels, u8 bit depth. Little endian, the way this only ever runs
+		constexpr uint32_t imageIndexMagic        = 0x4949554D;
+		constexpr uint32_t imageIndexVersion      = 1;
+		constexpr size_t   imageIndexMinEntrySize = 2 + 8 + 8 + 1 + 4 + 4 + 1 + 1; // an entry with an empty path
+
+		template <typename T>
+		void writeRaw(std::string &out, T value) {
+			out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+		}
+
+		template <typename T>
+		bool readRaw(std::string_view &in, T &value) {
+			if (in.size() < sizeof(T))
+				return false;
+			std::memcpy(&value, in.data(), sizeof(T));
+			in.remove_prefix(sizeof(T));
+			return true;
+		}
+	} // namespace
+
+	ImageIndex::ImageIndex(fs::path indexFile) : m_indexFile(std::move(indexFile)) {
+		std::error_code ec;
+		if (fs::exists(m_indexFile, ec) && !Load())
+			LOGERROR("Ignoring unreadable image index: {}", m_indexFile.string());
+	}
+
+	bool ImageIndex::Load() {
+		std::ifstream in(m_indexFile, std::ios::binary);
+		std::string   data{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+
+		std::string_view view = data;
+		uint32_t         magic = 0, version = 0, count = 0;
+		if (!readRaw(view, magic) || !readRaw(view, version) || !readRaw(view, count) || magic != imageIndexMagic ||
+		    version != imageIndexVersion)
+			return false;
+
+		// count comes from disk, so it only sizes the table as far as the data could actually back it
+		if (count > view.size() / imageIndexMinEntrySize)
+			return false;
+
+		std::unordered_map<fs::path::string_type, Entry> entries;
+		try {
+			entries.reserve(count);
+			for (uint32_t i = 0; i < count; ++i) {
+				uint16_t pathLength = 0;
+				if (!readRaw(view, pathLength) || view.size() < pathLength)
+					return false;
+				const std::u8string utf8Path(reinterpret_cast<const char8_t *>(view.data()), pathLength);
+				view.remove_prefix(pathLength);
+
+				Entry   entry;
+				uint8_t format = 0;
+				if (!readRaw(view, entry.fileSize) || !readRaw(view, entry.writeTime) || !readRaw(view, format) ||
+				    !readRaw(view, entry.metadata.width) || !readRaw(view, entry.metadata.height) ||
+				    !readRaw(view, entry.metadata.channels) || !readRaw(view, entry.metadata.bitDepth))
+					return false;
+				entry.metadata.format = static_cast<ImageFormat>(format);
+
+				entries[fs::path(utf8Path).native()] = entry;
+			}
+		} catch (const std::exception &e) { // allocation failure, or a path that doesn't convert on this platform
+			LOGERROR("Unable to load image index '{}': {}", m_indexFile.string(), e.what());
+			return false;
+		}
+
+		m_entries = std::move(entries);
+		m_dirty   = false;
+		return true;
+	}
+
+	bool ImageIndex::Save() {
+		if (!m_dirty)
+			return true;
+
+		std::string data;
+		writeRaw(data, imageIndexMagic);
+		writeRaw(data, imageIndexVersion);
+		writeRaw(data, uint32_t{0}); // entry count, patched in below once skipped entries are known
+
+		uint32_t count = 0;
+		for (const auto &[path, entry] : m_entries) {
+			const std::u8string utf8Path = fs::path(path).u8string();
+			if (utf8Path.size() > UINT16_MAX) {
+				// a truncated path would come back as a different key, so these just don't get cached
+				LOGERROR("Not saving image index entry, path is too long: {}", fs::path(path).string());
+				continue;
+			}
+
+			writeRaw(data, static_cast<uint16_t>(utf8Path.size()));
+			data.append(reinterpret_cast<const char *>(utf8Path.data()), utf8Path.size());
+			writeRaw(data, entry.fileSize);
+			writeRaw(data, entry.writeTime);
+			writeRaw(data, static_cast<uint8_t>(entry.metadata.format));
+			writeRaw(data, entry.metadata.width);
+			writeRaw(data, entry.metadata.height);
+			writeRaw(data, entry.metadata.channels);
+			writeRaw(data, entry.metadata.bitDepth);
+			++count;
+		}
+		std::memcpy(data.data() + 2 * sizeof(uint32_t), &count, sizeof(count));
+
+		if (!write_file_atomic(m_indexFile, data))
+			return false;
+
+		m_dirty = false;
+		return true;
+	}
+
+	std::vector<std::optional<ImageMetadata>> ImageIndex::Update(const std::vector<fs::path> &files) {
+		std::vector<std::optional<ImageMetadata>> results(files.size());
+		std::vector<Entry>                        stats(files.size());
+		std::vector<size_t>                       stale;
+
+		for (size_t i = 0; i < files.size(); ++i) {
+			std::error_code ec;
+			stats[i].fileSize  = fs::file_size(files[i], ec);
+			stats[i].writeTime = ec ? 0 : fs::last_write_time(files[i], ec).time_since_epoch().count();
+			if (ec)
+				continue;
+
+			auto it = m_entries.find(files[i].native());
+			if (it != m_entries.end() && it->second.fileSize == stats[i].fileSize && it->second.writeTime == stats[i].writeTime)
+				results[i] = it->second.metadata;
+			else
+				stale.push_back(i);
+		}
+
+		Helper::parallelFor(stale.size(), 32, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i)
+				results[stale[i]] = ProbeImage(files[stale[i]]);
+		});
+
+		// failed probes are indexed too (as ImageFormat::Unknown) so they aren't retried until the file changes
+		for (size_t i : stale) {
+			stats[i].metadata            = results[i].value_or(ImageMetadata{});
+			m_entries[files[i].native()] = stats[i];
+		}
+		m_dirty |= !stale.empty();
+
+		for (size_t i = 0; i < files.size(); ++i) {
+			if (results[i] && results[i]->format == ImageFormat::Unknown)
+				results[i].reset();
+		}
+		return results;
+	}
+
+	std::optional<ImageMetadata> ImageIndex::Find(const fs::path &file) const {
+		auto it = m_entries.find(file.native());
+		if (it == m_entries.end() || it->second.metadata.format == ImageFormat::Unknown)
+			return std::nullopt;
+		return it->second.metadata;
+	}
+
+	size_t ImageIndex::RemoveMissing() {
+		const size_t removed = std::erase_if(m_entries, [](const auto &entry) {
+			std::error_code ec;
+			return !fs::exists(entry.first, ec);
+		});
+		m_dirty |= removed > 0;
+		return removed;
+	}
+
+	void FindPngImages(const fs::path &directory, std::unordered_map<std::string, fs::path> &imageMap) {
+		for (auto &path : ScanImages(directory, true)) {
+			std::string filename = path.stem().string();
+			imageMap[filename]   = std::move(path);
+		}
+	}
+
+	void FindPngImages(const fs::path &directory, std::vector<ImageInfo> &image_info) {
+		for (auto &path : ScanImages(directory, true)) {
+			std::string filename = path.stem().string();
+			image_info.emplace_back(std::move(filename), std::move(path));
+		}
+	}
+
+	void FindPngImages(const fs::path &directory, std::map<std::string, ImageInfo> &image_info_map) {
+		for (auto &path : ScanImages(directory, true)) {
+			std::string filename     = path.stem().string();
+			image_info_map[filename] = {filename, std::move(path)};
+		}
+	}
+
+	// DirectoryWatcher class
+	DirectoryWatcher::DirectoryWatcher(fs::path directory, bool pngOnly, std::chrono::milliseconds batchDelay)
+	    : m_directory(std::move(directory)), m_pngOnly(pngOnly), m_batchDelay(batchDelay) {
+		// the watch goes up before the initial scan, so nothing can slip in between the two
+#ifdef _WIN32
+		m_directoryHandle = CreateFileW(m_directory.c_str(),
+		    FILE_LIST_DIRECTORY,
+		    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		    nullptr,
+		    OPEN_EXISTING,
+		    FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+		    nullptr);
+		m_stopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+		m_watching  = m_directoryHandle != INVALID_HANDLE_VALUE && m_stopEvent;
+#else
+		m_inotify  = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		m_stopFd   = eventfd(0, EFD_CLOEXEC);
+		m_watching = m_inotify >= 0 && m_stopFd >= 0;
+		if (m_watching)
+			WatchTree(m_directory);
+#endif
+		if (!m_watching)
+			LOGERROR("Unable to watch '{}', changes won't be picked up", m_directory.string());
+
+		for (auto &path : ScanImages(m_directory, m_pngOnly)) {
+			m_known.insert(path);
+			m_ready.push_back({Change::Kind::Added, std::move(path)});
+		}
+		m_hasChanges = !m_ready.empty();
+
+		if (m_watching)
+			m_worker = std::thread([this] { Run(); });
+	}
+
+	DirectoryWatcher::~DirectoryWatcher() {
+		m_stop = true;
+#ifdef _WIN32
+		if (m_stopEvent)
+			SetEvent(m_stopEvent);
+		if (m_worker.joinable())
+			m_worker.join();
+		if (m_directoryHandle != INVALID_HANDLE_VALUE)
+			CloseHandle(m_directoryHandle);
+		if (m_stopEvent)
+			CloseHandle(m_stopEvent);
+#else
+		if (m_stopFd >= 0) {
+			const uint64_t one = 1;
+			(void)::write(m_stopFd, &one, sizeof(one));
+		}
+		if (m_worker.joinable())
+			m_worker.join();
+		if (m_inotify >= 0)
+			::close(m_inotify);
+		if (m_stopFd >= 0)
+			::close(m_stopFd);
+#endif
+	}
+
+	std::vector<DirectoryWatcher::Change> DirectoryWatcher::Poll() {
+		if (!m_hasChanges.load(std::memory_order_acquire))
+			return {};
+
+		std::lock_guard lock(m_mutex);
+		m_hasChanges = false;
+		return std::exchange(m_ready, {});
+	}
+
+	bool DirectoryWatcher::IsWatchedImage(const fs::path &file) const {
+		const auto kind = imageKind(file.filename().native());
+		return kind && (!m_pngOnly || *kind == DirectoryListing::Kind::Png);
+	}
+
+#ifndef _WIN32
+	void DirectoryWatcher::WatchTree(const fs::path &directory) {
+		constexpr uint32_t mask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE | IN_ONLYDIR;
+
+		const int wd = inotify_add_watch(m_inotify, directory.c_str(), mask);
+		if (wd < 0)
+			return;
+		m_watches[wd] = directory;
+
+		std::error_code ec;
+		for (auto it = fs::recursive_directory_iterator(directory, fs::directory_options::skip_permission_denied, ec);
+		     !ec && it != fs::recursive_directory_iterator();
+		     it.increment(ec)) {
+			std::error_code typeEc;
+			if (it->is_directory(typeEc) && !it->is_symlink(typeEc)) {
+				if (const int childWd = inotify_add_watch(m_inotify, it->path().c_str(), mask); childWd >= 0)
+					m_watches[childWd] = it->path();
+			}
+		}
+	}
+
+	void DirectoryWatcher::UnwatchTree(const fs::path &directory) {
+		std::erase_if(m_watches, [&](const auto &watch) {
+			const auto &[wd, path] = watch;
+			if (std::mismatch(directory.begin(), directory.end(), path.begin(), path.end()).first != directory.end())
+				return false;
+			inotify_rm_watch(m_inotify, wd);
+			return true;
+		});
+	}
+#endif
+
+	// Turns the paths touched by a batch of events into changes, by comparing what's on disk now with what was known. That way the
+	// event order doesn't matter, and e.g. a file created and deleted within one batch produces nothing
+	void DirectoryWatcher::Settle(const std::set<fs::path> &dirty, const std::set<fs::path> &written) {
+		std::vector<Change> changes;
+
+		// every known image at or below path, which the set keeps contiguous
+		const auto knownBelow = [&](const fs::path &path) {
+			auto first = m_known.lower_bound(path), last = first;
+			while (last != m_known.end() && std::mismatch(path.begin(), path.end(), last->begin(), last->end()).first == path.end())
+				++last;
+			return std::pair(first, last);
+		};
+
+		for (const fs::path &path : dirty) {
+			std::error_code ec;
+			const auto      status = fs::status(path, ec);
+
+			if (fs::is_directory(status)) {
+#ifndef _WIN32
+				WatchTree(path); // new or moved in, so nothing below it is watched yet
+#endif
+				const std::vector<fs::path> images = ScanImages(path, m_pngOnly);
+				const std::set<fs::path>    present(images.begin(), images.end());
+
+				auto [first, last] = knownBelow(path);
+				for (auto it = first; it != last;) {
+					if (present.contains(*it)) {
+						++it;
+						continue;
+					}
+					changes.push_back({Change::Kind::Removed, *it});
+					it = m_known.erase(it);
+				}
+				for (const fs::path &image : images) {
+					if (m_known.insert(image).second)
+						changes.push_back({Change::Kind::Added, image});
+				}
+			} else if (fs::is_regular_file(status) && IsWatchedImage(path)) {
+				if (m_known.insert(path).second)
+					changes.push_back({Change::Kind::Added, path});
+				else if (written.contains(path))
+					changes.push_back({Change::Kind::Modified, path});
+			} else {
+				// gone (or no longer an image), along with everything below it if it was a directory
+#ifndef _WIN32
+				UnwatchTree(path);
+#endif
+				auto [first, last] = knownBelow(path);
+				for (auto it = first; it != last; ++it)
+					changes.push_back({Change::Kind::Removed, *it});
+				m_known.erase(first, last);
+			}
+		}
+
+		if (changes.empty())
+			return;
+
+		std::lock_guard lock(m_mutex);
+		std::ranges::move(changes, std::back_inserter(m_ready));
+		m_hasChanges.store(true, std::memory_order_release);
+	}
+
+	void DirectoryWatcher::Run() {
+		std::set<fs::path>                    dirty;   // paths to look at once the batch settles
+		std::set<fs::path>                    written; // files whose contents were written
+		std::chrono::steady_clock::time_point settleAt;
+
+		const auto touch = [&](fs::path path, bool wasWritten) {
+			if (dirty.empty())
+				settleAt = std::chrono::steady_clock::now() + m_batchDelay;
+			if (wasWritten)
+				written.insert(path);
+			dirty.insert(std::move(path));
+		};
+
+		const auto timeoutMs = [&]() -> int {
+			if (dirty.empty())
+				return -1;
+			const auto left = std::chrono::ceil<std::chrono::milliseconds>(settleAt - std::chrono::steady_clock::now());
+			return static_cast<int>(std::max<int64_t>(left.count(), 0));
+		};
+
+#ifdef _WIN32
+		constexpr DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE;
+
+		std::vector<DWORD> buffer(16 * 1024); // DWORD aligned, as ReadDirectoryChangesW requires
+		OVERLAPPED         overlapped{};
+		overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+
+		const auto watch = [&] {
+			ResetEvent(overlapped.hEvent);
+			return ReadDirectoryChangesW(m_directoryHandle,
+			    buffer.data(),
+			    static_cast<DWORD>(buffer.size() * sizeof(DWORD)),
+			    TRUE,
+			    filter,
+			    nullptr,
+			    &overlapped,
+			    nullptr);
+		};
+
+		bool pending = overlapped.hEvent && watch();
+		while (pending && !m_stop) {
+			const int    timeout   = timeoutMs();
+			const HANDLE handles[] = {m_stopEvent, overlapped.hEvent};
+			const DWORD  result    = WaitForMultipleObjects(2, handles, FALSE, timeout < 0 ? INFINITE : static_cast<DWORD>(timeout));
+
+			if (result == WAIT_OBJECT_0)
+				break;
+
+			if (result == WAIT_OBJECT_0 + 1) {
+				DWORD bytes = 0;
+				if (!GetOverlappedResult(m_directoryHandle, &overlapped, &bytes, FALSE) || bytes == 0) {
+					touch(m_directory, false); // the buffer overflowed, look at everything again
+				} else {
+					for (auto *info = reinterpret_cast<const FILE_NOTIFY_INFORMATION *>(buffer.data());;) {
+						const fs::path path = m_directory / std::wstring_view(info->FileName, info->FileNameLength / sizeof(WCHAR));
+						// directories report a modification whenever something inside them changes, those are covered already
+						if (info->Action != FILE_ACTION_MODIFIED || IsWatchedImage(path))
+							touch(path, info->Action == FILE_ACTION_MODIFIED);
+
+						if (!info->NextEntryOffset)
+							break;
+						info = reinterpret_cast<const FILE_NOTIFY_INFORMATION *>(reinterpret_cast<const char *>(info) + info->NextEntryOffset);
+					}
+				}
+				pending = watch();
+			}
+
+			if (!dirty.empty() && std::chrono::steady_clock::now() >= settleAt) {
+				Settle(dirty, written);
+				dirty.clear();
+				written.clear();
+			}
+		}
+
+		if (pending) {
+			CancelIoEx(m_directoryHandle, &overlapped);
+			DWORD bytes = 0;
+			GetOverlappedResult(m_directoryHandle, &overlapped, &bytes, TRUE);
+		}
+		if (overlapped.hEvent)
+			CloseHandle(overlapped.hEvent);
+#else
+		alignas(inotify_event) char buffer[64 * 1024];
+		while (!m_stop) {
+			pollfd fds[] = {{m_stopFd, POLLIN, 0}, {m_inotify, POLLIN, 0}};
+			if (::poll(fds, 2, timeoutMs()) < 0 && errno != EINTR)
+				break;
+			if (fds[0].revents & POLLIN)
+				break;
+
+			for (ssize_t length; (fds[1].revents & POLLIN) && (length = ::read(m_inotify, buffer, sizeof(buffer))) > 0;) {
+				for (const char *p = buffer; p < buffer + length;) {
+					const auto *event = reinterpret_cast<const inotify_event *>(p);
+					p += sizeof(inotify_event) + event->len;
+
+					if (event->mask & IN_Q_OVERFLOW) {
+						touch(m_directory, false); // events were lost, look at everything again
+						continue;
+					}
+					if (event->mask & IN_IGNORED) {
+						m_watches.erase(event->wd);
+						continue;
+					}
+
+					auto watch = m_watches.find(event->wd);
+					if (watch == m_watches.end() || event->len == 0)
+						continue;
+
+					fs::path path = watch->second / event->name;
+					if ((event->mask & IN_ISDIR) || IsWatchedImage(path))
+						touch(std::move(path), event->mask & IN_CLOSE_WRITE);
+				}
+			}
+
+			if (!dirty.empty() && std::chrono::steady_clock::now() >= settleAt) {
+				Settle(dirty, written);
+				dirty.clear();
+				written.clear();
+			}
+		}
+#endif
+	}
+
+	void OpenFolder(const fs::path &folderPath) {
+		if (fs::exists(folderPath))
+			ShellExecute(NULL, L"open", folderPath.c_str(), NULL, NULL, SW_SHOWNORMAL);
+		else
+			LOGERROR("Folder path does not exist: {}", folderPath.string());
+	}
+
+	void FilterLinesInFile(const fs::path &filePath, const std::string &startString) {
+		MappedFile input(filePath);
+		if (!input.IsOpen()) {
+			LOGERROR("Unable to open file {}", filePath.string());
+			return;
+		}
+
+		AtomicFileWriter output(filePath);
+		if (!output.IsOpen())
+			return;
+
+		const std::string_view text    = input.View();
+		const char            *textEnd = text.data() + text.size();
+
+		// chunks end on line boundaries so they can be filtered independently
+		constexpr size_t    chunkSize = 4 << 20;
+		std::vector<size_t> bounds{0};
+		while (bounds.back() < text.size()) {
+			const size_t target = std::min(bounds.back() + chunkSize, text.size());
+			bounds.push_back(std::min<size_t>(findNewline(text.data() + target - 1, textEnd) - text.data() + 1, text.size()));
+		}
+
+		// kept lines are collected as runs of the mapped input, consecutive kept lines share one run
+		std::vector<std::vector<std::string_view>> runs(bounds.size() - 1);
+		Helper::parallelFor(runs.size(), 1, [&](size_t begin, size_t end) {
+			for (size_t chunk = begin; chunk < end; ++chunk) {
+				const char *chunkEnd = text.data() + bounds[chunk + 1];
+				for (const char *line = text.data() + bounds[chunk]; line < chunkEnd;) {
+					const char *lineEnd = findNewline(line, chunkEnd);
+					const char *next    = lineEnd < chunkEnd ? lineEnd + 1 : chunkEnd;
+
+					if (static_cast<size_t>(lineEnd - line) >= startString.size() &&
+					    std::memcmp(line, startString.data(), startString.size()) == 0) {
+						auto &chunkRuns = runs[chunk];
+						if (!chunkRuns.empty() && chunkRuns.back().data() + chunkRuns.back().size() == line)
+							chunkRuns.back() = std::string_view(chunkRuns.back().data(), next - chunkRuns.back().data());
+						else
+							chunkRuns.emplace_back(line, next - line);
+					}
+					line = next;
+				}
+			}
+		});
+
+		std::string_view lastRun;
+		for (const auto &chunkRuns : runs) {
+			for (std::string_view run : chunkRuns)
+				output.Write(run);
+			if (!chunkRuns.empty())
+				lastRun = chunkRuns.back();
+		}
+
+		if (!lastRun.empty() && lastRun.back() != '\n') {
+			// every written line gets terminated, in the file's own style
+			const char *firstNewline = findNewline(text.data(), textEnd);
+			output.Write(firstNewline != textEnd && firstNewline != text.data() && firstNewline[-1] == '\r' ? "\r\n" : "\n");
+		}
+
+		input.Close(); // Windows can't replace a file that's still mapped
+		if (output.Commit())
+			LOG("Filtered lines saved to {}", filePath.string());
+	}
+
+	// MappedFile class
+	MappedFile::MappedFile(MappedFile &&other) noexcept { *this = std::move(other); }
+
+	MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+		if (this == &other)
+			return *this;
+
+		Close();
+		m_mapped = std::exchange(other.m_mapped, false);
+		m_size   = std::exchange(other.m_size, 0);
+		m_buffer = std::move(other.m_buffer);
+		m_data   = std::exchange(other.m_data, nullptr);
+		if (m_data && !m_mapped)
+			m_data = m_buffer.data(); // moved strings may relocate small buffers
+		return *this;
+	}
+
+	void MappedFile::Close() {
+		if (m_mapped) {
+#ifdef _WIN32
+			UnmapViewOfFile(m_data);
+#else
+			munmap(const_cast<char *>(m_data), m_size);
+#endif
+		}
+
+		m_data   = nullptr;
+		m_size   = 0;
+		m_mapped = false;
+		m_buffer = std::string();
+	}
+
+	bool MappedFile::Open(const fs::path &file) {
+		Close();
+
+#ifdef _WIN32
+		HANDLE handle = CreateFileW(file.c_str(),
+		    GENERIC_READ,
+		    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		    nullptr,
+		    OPEN_EXISTING,
+		    FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+		    nullptr);
+		if (handle == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER fileSize{};
+		if (!GetFileSizeEx(handle, &fileSize)) {
+			CloseHandle(handle);
+			return false;
+		}
+		const size_t size = static_cast<size_t>(fileSize.QuadPart);
+
+		if (size >= mapThreshold) {
+			// the view keeps the mapping alive, and the mapping keeps the file alive, so both handles can go right away
+			HANDLE mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			CloseHandle(handle);
+			if (!mapping)
+				return false;
+
+			const void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle(mapping);
+			if (!view)
+				return false;
+
+			m_data   = static_cast<const char *>(view);
+			m_size   = size;
+			m_mapped = true;
+			return true;
+		}
+
+		m_buffer.resize(size);
+		size_t total = 0;
+		while (total < size) {
+			DWORD chunk = 0;
+			if (!ReadFile(handle, m_buffer.data() + total, static_cast<DWORD>(size - total), &chunk, nullptr) || chunk == 0)
+				break;
+			total += chunk;
+		}
+		CloseHandle(handle);
+#else
+		const int fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0)
+			return false;
+
+		struct stat info{};
+		if (fstat(fd, &info) != 0) {
+			::close(fd);
+			return false;
+		}
+		const size_t size = static_cast<size_t>(info.st_size);
+
+		if (size >= mapThreshold) {
+			void *view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+			::close(fd); // the mapping holds its own reference
+			if (view == MAP_FAILED)
+				return false;
+			madvise(view, size, MADV_SEQUENTIAL);
+
+			m_data   = static_cast<const char *>(view);
+			m_size   = size;
+			m_mapped = true;
+			return true;
+		}
+
+		m_buffer.resize(size);
+		size_t total = 0;
+		while (total < size) {
+			const ssize_t chunk = ::read(fd, m_buffer.data() + total, size - total);
+			if (chunk <= 0)
+				break;
+			total += static_cast<size_t>(chunk);
+		}
+		::close(fd);
+#endif
+
+		m_buffer.resize(total); // in case the file shrank in between
+		m_data = m_buffer.data();
+		m_size = m_buffer.size();
+		return true;
+	}
+
+	// LineIndex class
+	bool LineIndex::Open(const fs::path &file) {
+		m_file = file;
+		m_newlines.clear();
+		m_tail.clear();
+		if (!m_mapped.Open(file))
+			return false;
+
+		Scan(0);
+		return true;
+	}
+
+	bool LineIndex::Refresh() {
+		MappedFile reopened(m_file);
+		if (!reopened.IsOpen())
+			return false;
+
+		const size_t           indexed = m_mapped.Size();
+		const std::string_view text    = reopened.View();
+		const bool appended = m_mapped.IsOpen() && text.size() >= indexed && text.substr(indexed - m_tail.size(), m_tail.size()) == m_tail;
+		if (appended && text.size() == indexed)
+			return false;
+
+		m_mapped = std::move(reopened);
+		if (!appended)
+			m_newlines.clear();
+		Scan(appended ? indexed : 0);
+		return true;
+	}
+
+	void LineIndex::Scan(size_t from) {
+		const std::string_view text = m_mapped.View();
+
+		// big ranges are split into blocks scanned in parallel, then stitched together in order
+		constexpr size_t                 blockSize = 4 << 20;
+		const size_t                     blocks    = (text.size() - from + blockSize - 1) / blockSize;
+		std::vector<std::vector<size_t>> found(blocks);
+		Helper::parallelFor(blocks, 1, [&](size_t begin, size_t end) {
+			for (size_t block = begin; block < end; ++block) {
+				const size_t blockBegin = from + block * blockSize;
+				found[block].reserve(blockSize / 64);
+				collectNewlines(text.data(), blockBegin, std::min(blockBegin + blockSize, text.size()), found[block]);
+			}
+		});
+
+		for (const auto &offsets : found)
+			m_newlines.insert(m_newlines.end(), offsets.begin(), offsets.end());
+
+		m_tail.assign(text.substr(text.size() - std::min(text.size(), tailCheckSize)));
+	}
+
+	size_t LineIndex::LineCount() const {
+		const size_t lastBegin = m_newlines.empty() ? 0 : m_newlines.back() + 1;
+		return m_newlines.size() + (lastBegin < m_mapped.Size() ? 1 : 0);
+	}
+
+	size_t LineIndex::LineBegin(size_t line) const { return line == 0 ? 0 : m_newlines[line - 1] + 1; }
+
+	size_t LineIndex::LineEnd(size_t line) const {
+		const size_t begin = LineBegin(line);
+		const size_t end   = line < m_newlines.size() ? m_newlines[line] : m_mapped.Size();
+		return end > begin && m_mapped.View()[end - 1] == '\r' ? end - 1 : end;
+	}
+
+	std::string_view LineIndex::Line(size_t line) const {
+		if (line >= LineCount())
+			return {};
+
+		const size_t begin = LineBegin(line);
+		return m_mapped.View().substr(begin, LineEnd(line) - begin);
+	}
+
+	std::vector<std::string_view> LineIndex::Lines(const std::vector<size_t> &lineNumbers) const {
+		std::vector<std::string_view> lines;
+		lines.reserve(lineNumbers.size());
+		for (size_t line : lineNumbers)
+			lines.push_back(Line(line));
+		return lines;
+	}
+
+	std::vector<size_t> LineIndex::MatchLines(size_t first, size_t last, std::string_view term, bool ignoreCase) const {
+		std::vector<size_t> hits;
+		if (term.empty()) {
+			hits.resize(last - first);
+			std::iota(hits.begin(), hits.end(), first);
+			return hits;
+		}
+		if (first >= last || term.find('\n') != std::string_view::npos)
+			return hits;
+
+		// searches the whole range at once rather than line by line, and only looks up the line of each match
+		const char *text     = m_mapped.View().data();
+		const char *rangeEnd = text + LineEnd(last - 1);
+		for (size_t line = first, pos = LineBegin(first);;) {
+			const char *match = findTerm(text + pos, rangeEnd, term, ignoreCase);
+			if (!match)
+				break;
+
+			const size_t offset = match - text;
+			line                = std::lower_bound(m_newlines.begin() + line, m_newlines.end(), offset) - m_newlines.begin();
+			if (offset + term.size() <= LineEnd(line))
+				hits.push_back(line);
+
+			if (++line >= last)
+				break;
+			pos = LineBegin(line);
+		}
+		return hits;
+	}
+
+	std::vector<size_t> LineIndex::Search(std::string_view term, bool ignoreCase) const { return SearchTerms({term}, ignoreCase); }
+
+	std::vector<size_t> LineIndex::SearchTerms(const std::vector<std::string_view> &terms, bool ignoreCase, bool matchAll) const {
+		if (terms.empty())
+			return {};
+
+		std::vector<std::string> folded(terms.begin(), terms.end());
+		if (ignoreCase) {
+			for (auto &term : folded)
+				std::ranges::transform(term, term.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		}
+
+		// matching every term only needs the candidates of the longest one, which tends to be the rarest
+		if (matchAll)
+			std::ranges::sort(folded, std::greater{}, &std::string::size);
+
+		std::mutex                            resultsMutex;
+		std::map<size_t, std::vector<size_t>> results; // by first line of the chunk
+		Helper::parallelFor(LineCount(), 16384, [&](size_t begin, size_t end) {
+			std::vector<size_t> hits = MatchLines(begin, end, folded[0], ignoreCase);
+
+			for (size_t i = 1; i < folded.size(); ++i) {
+				const std::string_view term = folded[i];
+				if (matchAll) {
+					std::erase_if(hits, [&](size_t line) {
+						const std::string_view text = Line(line);
+						return !findTerm(text.data(), text.data() + text.size(), term, ignoreCase);
+					});
+					continue;
+				}
+
+				std::vector<size_t> termHits = MatchLines(begin, end, term, ignoreCase), merged;
+				merged.reserve(hits.size() + termHits.size());
+				std::ranges::set_union(hits, termHits, std::back_inserter(merged));
+				hits = std::move(merged);
+			}
+
+			std::lock_guard lock(resultsMutex);
+			results.emplace(begin, std::move(hits));
+		});
+
+		std::vector<size_t> lines;
+		for (const auto &[begin, hits] : results)
+			lines.insert(lines.end(), hits.begin(), hits.end());
+		return lines;
+	}
+
+	// IOQueue class
+	IOQueue::IOQueue(size_t numThreads) {
+		m_workers.reserve(std::max<size_t>(numThreads, 1));
+		for (size_t i = 0; i < std::max<size_t>(numThreads, 1); ++i)
+			m_workers.emplace_back([this] { Run(); });
+	}
+
+	IOQueue &IOQueue::Shared() {
+		static IOQueue queue;
+		return queue;
+	}
+
+	void IOQueue::Run() {
+		std::unique_lock lock(m_mutex);
+		while (true) {
+			m_wake.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+			if (m_jobs.empty())
+				return; // stopping
+
+			Job job = std::move(m_jobs.front());
+			m_jobs.pop_front();
+			++m_running;
+			lock.unlock();
+
+			// a throwing job would otherwise take the whole process down through std::terminate
+			try {
+				job.run();
+			} catch (const std::exception &e) {
+				LOGERROR("IOQueue job {} threw: {}", job.id, e.what());
+			} catch (...) {
+				LOGERROR("IOQueue job {} threw an unknown exception", job.id);
+			}
+			job.run = nullptr; // captures are released before the job counts as done
+
+			lock.lock();
+			if (--m_running == 0 && m_jobs.empty())
+				m_idle.notify_all();
+		}
+	}
+
+	uint64_t IOQueue::Post(std::function<void()> job) {
+		uint64_t id = 0;
+		{
+			std::lock_guard lock(m_mutex);
+			if (m_stop)
+				return 0; // dropping the job breaks its promise, so waiters don't hang
+			id = m_nextId++;
+			m_jobs.push_back({id, std::move(job)});
+		}
+		m_wake.notify_one();
+		return id;
+	}
+
+	std::vector<uint64_t> IOQueue::PostBatch(std::vector<std::function<void()>> jobs) {
+		std::vector<uint64_t> ids(jobs.size());
+		{
+			std::lock_guard lock(m_mutex);
+			if (m_stop)
+				return ids;
+			for (size_t i = 0; i < jobs.size(); ++i) {
+				ids[i] = m_nextId++;
+				m_jobs.push_back({ids[i], std::move(jobs[i])});
+			}
+		}
+		m_wake.notify_all();
+		return ids;
+	}
+
+	bool IOQueue::Cancel(uint64_t id) {
+		std::function<void()> cancelled; // destroyed outside the lock
+		{
+			std::lock_guard lock(m_mutex);
+			// ids are handed out in order, so the queue is sorted by them
+			auto it = std::ranges::lower_bound(m_jobs, id, {}, &Job::id);
+			if (it == m_jobs.end() || it->id != id)
+				return false;
+
+			cancelled = std::move(it->run);
+			m_jobs.erase(it);
+			if (m_running == 0 && m_jobs.empty())
+				m_idle.notify_all();
+		}
+		return true;
+	}
+
+	size_t IOQueue::CancelAll() {
+		std::deque<Job> cancelled;
+		{
+			std::lock_guard lock(m_mutex);
+			cancelled.swap(m_jobs);
+			if (m_running == 0)
+				m_idle.notify_all();
+		}
+		return cancelled.size();
+	}
+
+	size_t IOQueue::Pending() {
+		std::lock_guard lock(m_mutex);
+		return m_jobs.size() + m_running;
+	}
+
+	void IOQueue::WaitIdle() {
+		std::unique_lock lock(m_mutex);
+		m_idle.wait(lock, [this] { return m_jobs.empty() && m_running == 0; });
+	}
+
+	void IOQueue::Shutdown() {
+		{
+			std::lock_guard lock(m_mutex);
+			m_stop = true;
+		}
+		CancelAll();
+		m_wake.notify_all();
+
+		for (auto &worker : m_workers)
+			worker.join();
+		m_workers.clear();
+	}
+
+	std::future<std::string> get_text_content_async(const fs::path &file_path, IOQueue &queue) {
+		return queue.Submit([file_path] { return get_text_content(file_path); }).future;
+	}
+
+#ifndef NO_JSON
+	std::future<json> get_json_async(const fs::path &file_path, IOQueue &queue) {
+		return queue.Submit([file_path] { return get_json(file_path); }).future;
+	}
+
+	std::future<bool> write_json_async(const fs::path &file_path, json j, bool compact, IOQueue &queue) {
+		// serialized on the worker too
+		return queue.Submit([file_path, j = std::move(j), compact] { return write_json(file_path, j, compact); }).future;
+	}
+#endif
+
+	std::future<std::vector<uint8_t>> read_file_async(const fs::path &file, IOQueue &queue) {
+		return queue
+		    .Submit([file] {
+			    MappedFile mapped(file);
+			    if (!mapped.IsOpen()) {
+				    LOGERROR("Unable to read '{}'", file.string());
+				    return std::vector<uint8_t>();
+			    }
+
+			    const std::string_view view = mapped.View();
+			    return std::vector<uint8_t>(view.begin(), view.end());
+		    })
+		    .future;
+	}
+
+	std::future<std::optional<ImageMetadata>> ProbeImageAsync(const fs::path &file, IOQueue &queue) {
+		return queue.Submit([file] { return ProbeImage(file); }).future;
+	}
+
+	// Snapshot class
+	namespace {
+		constexpr uint32_t snapshotMagic = 0x5353554D; // "MUSS"
+
+		struct SnapshotHeader {
+			uint32_t magic;
+			uint16_t version;
+			uint16_t headerSize; // so later versions can grow the header
+			uint32_t fieldCount;
+			uint32_t keyField; // UINT32_MAX if the records aren't keyed
+			uint64_t recordCount;
+			uint64_t recordSize;
+			uint64_t fieldsOffset; // SnapshotField[fieldCount]
+			uint64_t recordsOffset;
+			uint64_t stringsOffset;
+			uint64_t stringsSize;
+		};
+
+		struct SnapshotField {
+			uint32_t nameOffset;
+			uint32_t nameLength;
+			uint32_t slotOffset;
+			uint8_t  type;
+			uint8_t  reserved[3];
+		};
+
+		// strings are stored as (offset << 32 | length) into the string table
+		std::optional<std::string_view> snapshotString(std::string_view strings, uint64_t bits) {
+			const uint64_t offset = bits >> 32, length = bits & 0xFFFFFFFF;
+			if (offset + length > strings.size())
+				return std::nullopt;
+			return strings.substr(offset, length);
+		}
+	} // namespace
+
+	bool Snapshot::Open(const fs::path &file) {
+		*this = {};
+		if (!m_mapped.Open(file)) {
+			LOGERROR("Unable to open snapshot '{}'", file.string());
+			return false;
+		}
+
+		std::string_view data = m_mapped.View();
+		SnapshotHeader   header{};
+		const auto       fail = [&](std::string_view reason) {
+			LOGERROR("Invalid snapshot '{}': {}", file.string(), reason);
+			*this = {};
+			return false;
+		};
+
+		if (!readRaw(data, header) || header.magic != snapshotMagic)
+			return fail("not a snapshot");
+		if (header.version > version)
+			return fail(std::format("version {} is newer than {}", header.version, version));
+
+		const uint64_t size        = m_mapped.Size();
+		const uint64_t bitmapBytes = (header.fieldCount + 63) / 64 * 8;
+		const bool     inBounds =
+		    header.headerSize >= sizeof(SnapshotHeader) && header.fieldsOffset <= size &&
+		    header.fieldCount <= (size - header.fieldsOffset) / sizeof(SnapshotField) && header.stringsOffset <= size &&
+		    header.stringsSize <= size - header.stringsOffset && header.recordsOffset <= size && header.recordSize > 0 &&
+		    header.recordSize >= bitmapBytes + 8ull * header.fieldCount &&
+		    header.recordCount <= (size - header.recordsOffset) / header.recordSize;
+		if (!inBounds)
+			return fail("truncated or corrupt");
+
+		const char *base = m_mapped.View().data();
+		m_strings        = std::string_view(base + header.stringsOffset, header.stringsSize);
+		m_records        = base + header.recordsOffset;
+		m_recordCount    = header.recordCount;
+		m_recordSize     = header.recordSize;
+		m_keyField       = header.keyField < header.fieldCount ? header.keyField : SIZE_MAX;
+
+		m_fields.reserve(header.fieldCount);
+		for (uint32_t i = 0; i < header.fieldCount; ++i) {
+			SnapshotField field{};
+			std::memcpy(&field, base + header.fieldsOffset + i * sizeof(SnapshotField), sizeof(field));
+
+			const auto name = snapshotString(m_strings, uint64_t(field.nameOffset) << 32 | field.nameLength);
+			if (!name || field.type > static_cast<uint8_t>(FieldType::Json) || field.slotOffset < bitmapBytes ||
+			    field.slotOffset + 8ull > m_recordSize)
+				return fail("bad field table");
+			m_fields.push_back({*name, static_cast<FieldType>(field.type), field.slotOffset});
+		}
+
+		m_open = true;
+		return true;
+	}
+
+	std::optional<size_t> Snapshot::FindField(std::string_view name) const {
+		for (size_t i = 0; i < m_fields.size(); ++i) {
+			if (m_fields[i].name == name)
+				return i;
+		}
+		return std::nullopt;
+	}
+
+	bool Snapshot::Record::Has(size_t field) const {
+		return field < m_snapshot->m_fields.size() && (static_cast<unsigned char>(m_data[field / 8]) >> (field % 8) & 1);
+	}
+
+	bool Snapshot::Record::Slot(size_t field, FieldType type, uint64_t &bits) const {
+		if (!Has(field) || m_snapshot->m_fields[field].type != type)
+			return false;
+		std::memcpy(&bits, m_data + m_snapshot->m_fields[field].slotOffset, sizeof(bits));
+		return true;
+	}
+
+	std::optional<bool> Snapshot::Record::GetBool(size_t field) const {
+		uint64_t bits = 0;
+		return Slot(field, FieldType::Bool, bits) ? std::optional(bits != 0) : std::nullopt;
+	}
+
+	std::optional<int64_t> Snapshot::Record::GetInt(size_t field) const {
+		uint64_t bits = 0;
+		return Slot(field, FieldType::Int, bits) ? std::optional(static_cast<int64_t>(bits)) : std::nullopt;
+	}
+
+	std::optional<double> Snapshot::Record::GetFloat(size_t field) const {
+		if (auto value = GetInt(field))
+			return static_cast<double>(*value);
+
+		uint64_t bits = 0;
+		return Slot(field, FieldType::Float, bits) ? std::optional(std::bit_cast<double>(bits)) : std::nullopt;
+	}
+
+	std::optional<std::string_view> Snapshot::Record::GetString(size_t field) const {
+		uint64_t bits = 0;
+		if (!Slot(field, FieldType::String, bits) && !Slot(field, FieldType::Json, bits))
+			return std::nullopt;
+		return snapshotString(m_snapshot->m_strings, bits);
+	}
+
+#ifndef NO_JSON
+	json Snapshot::Record::Get(size_t field) const {
+		if (!Has(field))
+			return nullptr;
+
+		switch (m_snapshot->m_fields[field].type) {
+		case FieldType::Bool:
+			return *GetBool(field);
+		case FieldType::Int:
+			return *GetInt(field);
+		case FieldType::Float:
+			return *GetFloat(field);
+		case FieldType::String:
+			return std::string(GetString(field).value_or(""));
+		case FieldType::Json: {
+			const auto text = GetString(field);
+			return text ? json::parse(*text, nullptr, false) : json();
+		}
+		}
+		return nullptr;
+	}
+
+	json Snapshot::Record::ToJson() const {
+		json object = json::object();
+		for (size_t field = 0; field < m_snapshot->m_fields.size(); ++field) {
+			if (field != m_snapshot->m_keyField && Has(field))
+				object[std::string(m_snapshot->m_fields[field].name)] = Get(field);
+		}
+		return object;
+	}
+
+	json Snapshot::ToJson() const {
+		json data = m_keyField == SIZE_MAX ? json::array() : json::object();
+		for (size_t i = 0; i < m_recordCount; ++i) {
+			const Record record = (*this)[i];
+			if (m_keyField == SIZE_MAX)
+				data.push_back(record.ToJson());
+			else
+				data[std::string(record.GetString(m_keyField).value_or(""))] = record.ToJson();
+		}
+		return data;
+	}
+
+	bool Snapshot::Write(const fs::path &file, const json &data) {
+		const bool keyed = data.is_object();
+		if (!keyed && !data.is_array()) {
+			LOGERROR("Snapshot data for '{}' must be an array or object of objects", file.string());
+			return false;
+		}
+
+		// the type a value would be stored as on its own
+		const auto typeOf = [](const json &value) {
+			switch (value.type()) {
+			case json::value_t::boolean:
+				return FieldType::Bool;
+			case json::value_t::number_integer:
+				return FieldType::Int;
+			case json::value_t::number_unsigned:
+				return value.get<uint64_t>() <= INT64_MAX ? FieldType::Int : FieldType::Json;
+			case json::value_t::number_float:
+				return FieldType::Float;
+			case json::value_t::string:
+				return FieldType::String;
+			default:
+				return FieldType::Json;
+			}
+		};
+
+		// field order is the order names first appear in, with the key first
+		std::vector<std::string>                          names;
+		std::vector<FieldType>                            types;
+		std::vector<bool>                                 exactInts; // every integer so far fits a double exactly
+		std::unordered_map<std::string, size_t>           fieldIndex;
+		std::vector<std::pair<std::string, const json *>> records; // key (if keyed), object
+		if (keyed) {
+			names.push_back("");
+			types.push_back(FieldType::String);
+			exactInts.push_back(true);
+		}
+
+		for (auto it = data.begin(); it != data.end(); ++it) {
+			if (!it->is_object()) {
+				LOGERROR("Snapshot data for '{}' must be an array or object of objects", file.string());
+				return false;
+			}
+			records.emplace_back(keyed ? it.key() : std::string(), &*it);
+
+			for (const auto &[name, value] : it->items()) {
+				const FieldType type  = typeOf(value);
+				const bool      exact = type != FieldType::Int || std::abs(static_cast<double>(value.get<int64_t>())) <= 0x1p53;
+
+				auto [entry, added] = fieldIndex.try_emplace(name, names.size());
+				if (added) {
+					names.push_back(name);
+					types.push_back(type);
+					exactInts.push_back(exact);
+					continue;
+				}
+
+				const size_t field = entry->second;
+				exactInts[field]   = exactInts[field] && exact;
+
+				FieldType &fieldType = types[field];
+				const bool numeric   = (fieldType == FieldType::Int || fieldType == FieldType::Float) &&
+				                     (type == FieldType::Int || type == FieldType::Float);
+				if (fieldType != type)
+					fieldType = numeric && exactInts[field] ? FieldType::Float : FieldType::Json;
+			}
+		}
+
+		std::string                               strings;
+		std::unordered_map<std::string, uint64_t> stringRefs; // deduplicated
+		const auto                                addString = [&](std::string_view text) {
+			auto [it, added] = stringRefs.try_emplace(std::string(text), 0);
+			if (added) {
+				it->second = static_cast<uint64_t>(strings.size()) << 32 | text.size();
+				strings.append(text);
+			}
+			return it->second;
+		};
+
+		SnapshotHeader header{};
+		header.magic       = snapshotMagic;
+		header.version     = version;
+		header.headerSize  = sizeof(SnapshotHeader);
+		header.fieldCount  = static_cast<uint32_t>(names.size());
+		header.keyField    = keyed ? 0 : UINT32_MAX;
+		header.recordCount = records.size();
+
+		const uint64_t bitmapBytes = (names.size() + 63) / 64 * 8;
+		header.recordSize          = std::max<uint64_t>(bitmapBytes + 8 * names.size(), 8);
+
+		std::vector<SnapshotField> fields(names.size());
+		for (size_t field = 0; field < names.size(); ++field) {
+			const uint64_t name      = addString(names[field]);
+			fields[field].nameOffset = static_cast<uint32_t>(name >> 32);
+			fields[field].nameLength = static_cast<uint32_t>(name);
+			fields[field].slotOffset = static_cast<uint32_t>(bitmapBytes + 8 * field);
+			fields[field].type       = static_cast<uint8_t>(types[field]);
+		}
+
+		std::string recordData(records.size() * header.recordSize, '\0');
+		for (size_t i = 0; i < records.size(); ++i) {
+			char      *record = recordData.data() + i * header.recordSize;
+			const auto store  = [&](size_t field, uint64_t bits) {
+				record[field / 8] |= static_cast<char>(1 << (field % 8));
+				std::memcpy(record + fields[field].slotOffset, &bits, sizeof(bits));
+			};
+
+			const auto &[key, object] = records[i];
+			if (keyed)
+				store(0, addString(key));
+
+			for (const auto &[name, value] : object->items()) {
+				const size_t field = fieldIndex.at(name);
+				switch (types[field]) {
+				case FieldType::Bool:
+					store(field, value.get<bool>());
+					break;
+				case FieldType::Int:
+					store(field, static_cast<uint64_t>(value.get<int64_t>()));
+					break;
+				case FieldType::Float:
+					store(field, std::bit_cast<uint64_t>(value.get<double>()));
+					break;
+				case FieldType::String:
+					store(field, addString(value.get_ref<const std::string &>()));
+					break;
+				case FieldType::Json:
+					store(field, addString(value.dump()));
+					break;
+				}
+			}
+		}
+
+		if (strings.size() > UINT32_MAX) {
+			LOGERROR("Snapshot strings for '{}' exceed 4 GB", file.string());
+			return false;
+		}
+
+		header.fieldsOffset  = sizeof(SnapshotHeader);
+		header.recordsOffset = (header.fieldsOffset + fields.size() * sizeof(SnapshotField) + 7) / 8 * 8;
+		header.stringsOffset = header.recordsOffset + recordData.size();
+		header.stringsSize   = strings.size();
+
+		std::string contents;
+		contents.reserve(header.stringsOffset + strings.size());
+		writeRaw(contents, header);
+		contents.append(reinterpret_cast<const char *>(fields.data()), fields.size() * sizeof(SnapshotField));
+		contents.resize(header.recordsOffset, '\0');
+		contents += recordData;
+		contents += strings;
+		return write_file_atomic(file, contents);
+	}
+#endif
+
+	std::string get_text_content(const fs::path &file_path) {
+		if (!fs::exists(file_path)) {
+			LOG("[ERROR] File doesn't exist: '{}'", file_path.string());
+			return std::string();
+		}
+
+		MappedFile file(file_path);
+		if (!file.IsOpen())
+			return std::string();
+
+#ifdef _WIN32
+		// this used to go through a text mode ifstream, keep its CRLF --> LF translation
+		const std::string_view view = file.View();
+		std::string            text;
+		text.resize(view.size());
+		size_t length = 0;
+		for (size_t i = 0; i < view.size(); ++i) {
+			if (view[i] != '\r' || i + 1 == view.size() || view[i + 1] != '\n')
+				text[length++] = view[i];
+		}
+		text.resize(length);
+		return text;
+#else
+		return std::string(file.View());
+#endif
+	}
+
+#ifndef NO_JSON
+
+	json get_json(const fs::path &file_path) {
+		json j;
+
+		if (!fs::exists(file_path)) {
+			LOG("[ERROR] File doesn't exist: '{}'", file_path.string());
+			return j;
+		}
+
+		try {
+			MappedFile file(file_path);
+			if (!file.IsOpen()) {
+				LOG("[ERROR] Unable to open '{}'", file_path.filename().string());
+				return j;
+			}
+
+			// parsing from contiguous memory skips the per-character stream reads
+			const std::string_view view = file.View();
+			j                           = json::parse(view.begin(), view.end());
+		} catch (const std::exception &e) {
+			LOG("[ERROR] Unable to read '{}': {}", file_path.filename().string(), e.what());
+		}
+
+		return j;
+	}
+
+	bool write_json(const fs::path &file_path, const json &j, bool compact) {
+		try {
+			if (!write_file_atomic(file_path, compact ? j.dump() : j.dump(4))) { // pretty-print with 4 spaces indentation
+				LOG("[ERROR] Couldn't open file for writing: {}", file_path.string());
+				return false;
+			}
+
+			return true;
+		} catch (const std::exception &e) {
+			LOG("[ERROR] Unable to write to '{}': {}", file_path.filename().string(), e.what());
+			return false;
+		}
+	}
+#endif
+
+	bool write_file_atomic(const fs::path &file, std::string_view contents) {
+		AtomicFileWriter writer(file);
+		writer.Write(contents);
+		return writer.Commit();
+	}
+
+	// AsyncWriter class
+	AsyncWriter::AsyncWriter(std::chrono::milliseconds coalesceDelay) : m_coalesceDelay(coalesceDelay), m_worker([this] { Run(); }) {}
+
+	AsyncWriter::~AsyncWriter() {
+		Flush();
+		{
+			std::lock_guard lock(m_mutex);
+			m_stop = true;
+		}
+		m_wake.notify_all();
+		m_worker.join();
+	}
+
+	void AsyncWriter::Enqueue(const fs::path &file, PendingWrite write) {
+		{
+			std::lock_guard lock(m_mutex);
+			auto [it, inserted] = m_pending.try_emplace(file);
+			// a newer snapshot replaces the pending one but keeps its deadline, so constant saving can't postpone the write forever
+			write.due  = inserted ? std::chrono::steady_clock::now() + m_coalesceDelay : it->second.due;
+			it->second = std::move(write);
+		}
+		m_wake.notify_all();
+	}
+
+	void AsyncWriter::Write(const fs::path &file, std::string contents) {
+		PendingWrite write;
+		write.contents = std::move(contents);
+		Enqueue(file, std::move(write));
+	}
+
+#ifndef NO_JSON
+	void AsyncWriter::WriteJson(const fs::path &file, json snapshot, bool compact) {
+		PendingWrite write;
+		write.snapshot = std::move(snapshot);
+		write.compact  = compact;
+		Enqueue(file, std::move(write));
+	}
+#endif
+
+	void AsyncWriter::Run() {
+		std::unique_lock lock(m_mutex);
+		while (true) {
+			const auto now = std::chrono::steady_clock::now();
+
+			std::vector<std::pair<fs::path, PendingWrite>> ready;
+			for (auto it = m_pending.begin(); it != m_pending.end();) {
+				if (m_flushing || m_stop || it->second.due <= now) {
+					ready.emplace_back(it->first, std::move(it->second));
+					it = m_pending.erase(it);
+				} else {
+					++it;
+				}
+			}
+
+			if (!ready.empty()) {
+				m_inFlight += ready.size();
+				lock.unlock();
+
+				size_t failed = 0;
+				for (auto &[file, write] : ready) {
+					try {
+#ifndef NO_JSON
+						if (write.snapshot)
+							write.contents = write.compact ? write.snapshot->dump() : write.snapshot->dump(4);
+#endif
+						failed += !write_file_atomic(file, write.contents);
+					} catch (const std::exception &e) {
+						LOGERROR("Unable to serialize '{}': {}", file.string(), e.what());
+						++failed;
+					}
+				}
+
+				lock.lock();
+				m_inFlight -= ready.size();
+				m_failed += failed;
+				continue; // more may have been queued meanwhile
+			}
+
+			if (m_pending.empty() && m_inFlight == 0)
+				m_drained.notify_all();
+			if (m_stop)
+				return;
+
+			if (m_pending.empty() || m_flushing) {
+				m_wake.wait(lock);
+			} else {
+				auto nextDue = m_pending.begin()->second.due;
+				for (const auto &[file, write] : m_pending)
+					nextDue = std::min(nextDue, write.due);
+				m_wake.wait_until(lock, nextDue);
+			}
+		}
+	}
+
+	bool AsyncWriter::Flush() {
+		std::unique_lock lock(m_mutex);
+		m_flushing = true;
+		m_wake.notify_all();
+		m_drained.wait(lock, [this] { return m_pending.empty() && m_inFlight == 0; });
+		m_flushing = false;
+
+		const bool ok = m_failed == 0;
+		m_failed      = 0;
+		return ok;
+	}
+
+	size_t AsyncWriter::Pending() {
+		std::lock_guard lock(m_mutex);
+		return m_pending.size() + m_inFlight;
+	}
+
+	namespace {
+		// FNV-1a, built up byte by byte while scanning so lines never have to be copied out
+		constexpr uint64_t lineHashSeed = 0xCBF29CE484222325ull;
+
+		constexpr uint64_t hashLine(std::string_view line, uint64_t hash = lineHashSeed) {
+			for (char c : line)
+				hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001B3ull;
+			return hash;
+		}
+
+		struct LineHashIndex {
+			uintmax_t                    fileSize  = 0;
+			fs::file_time_type           writeTime = {};
+			std::unordered_set<uint64_t> hashes;
+			bool                         endsWithNewline = true;
+			bool                         crlf            = false;
+		};
+
+		// each index costs about 40 bytes per distinct line, so only the most recently appended-to files keep theirs
+		constexpr size_t lineIndexCacheSize = 16;
+
+		std::mutex              lineIndexMutex;
+		LruCache<LineHashIndex> lineIndexes{lineIndexCacheSize};
+
+		bool appendToFile(const fs::path &file, std::string_view data) {
+#ifdef _WIN32
+			// FILE_APPEND_DATA without FILE_WRITE_DATA makes every write land at the current end of file
+			HANDLE handle = CreateFileW(
+			    file.c_str(), FILE_APPEND_DATA, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (handle == INVALID_HANDLE_VALUE)
+				return false;
+
+			DWORD      written = 0;
+			const bool ok      = WriteFile(handle, data.data(), static_cast<DWORD>(data.size()), &written, nullptr) && written == data.size();
+			CloseHandle(handle);
+			return ok;
+#else
+			const int fd = ::open(file.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+			if (fd < 0)
+				return false;
+
+			const bool ok = ::write(fd, data.data(), data.size()) == static_cast<ssize_t>(data.size());
+			::close(fd);
+			return ok;
+#endif
+		}
+	} // namespace
+
+	void appendLineIfNotExist(const fs::path &file, const std::string &line, bool cacheLines) {
+		const std::string fileName = file.filename().string();
+		const uint64_t    lineHash = hashLine(line);
+
+		std::unique_lock<std::mutex> indexLock;
+		LineHashIndex                scanned;
+		LineHashIndex               *index = &scanned;
+		if (cacheLines) {
+			indexLock = std::unique_lock(lineIndexMutex);
+			index     = &lineIndexes.GetOrCreate(file.native()); // stays valid while the lock is held
+		}
+
+		std::error_code ec;
+		const uintmax_t fileSize  = fs::file_size(file, ec);
+		const bool      exists    = !ec;
+		const auto      writeTime = exists ? fs::last_write_time(file, ec) : fs::file_time_type{};
+
+		if (!exists) {
+			LOG("WARNING: File doesn't exist: \"{}\"", file.string());
+			*index = LineHashIndex{};
+		} else if (!cacheLines || index->fileSize != fileSize || index->writeTime != writeTime || index->hashes.empty()) {
+			// scan the file in place, comparing each line as it goes by
+			MappedFile mapped(file);
+			if (!mapped.IsOpen()) {
+				LOGERROR("Unable to read {}", file.string());
+				return;
+			}
+
+			*index           = {};
+			index->fileSize  = fileSize;
+			index->writeTime = writeTime;
+
+			const std::string_view text  = mapped.View();
+			bool                   found = false;
+			for (size_t start = 0; start < text.size() && (!found || cacheLines);) {
+				size_t end = text.find('\n', start);
+				if (end == std::string_view::npos)
+					end = text.size();
+
+				std::string_view existingLine = text.substr(start, end - start);
+				if (!existingLine.empty() && existingLine.back() == '\r') { // same as a text mode getline would see it
+					existingLine.remove_suffix(1);
+					index->crlf = true;
+				}
+
+				found |= existingLine == line;
+				if (cacheLines)
+					index->hashes.insert(hashLine(existingLine));
+				start = end + 1;
+			}
+			index->endsWithNewline = text.empty() || text.back() == '\n';
+
+			if (found) {
+				LOG("{} already contains line: \"{}\"", fileName, line);
+				return;
+			}
+		} else if (index->hashes.contains(lineHash)) {
+			// a 64-bit hash match stands in for the comparison, a false positive is far less likely than the file changing under us
+			LOG("{} already contains line: \"{}\"", fileName, line);
+			return;
+		}
+
+		// keep the file's own line endings, and finish an unterminated last line first
+#ifdef _WIN32
+		const std::string_view newline = (index->crlf || !exists) ? "\r\n" : "\n";
+#else
+		const std::string_view newline = index->crlf ? "\r\n" : "\n";
+#endif
+		std::string data;
+		if (!index->endsWithNewline)
+			data += newline;
+		data += line;
+		data += newline;
+
+		if (!appendToFile(file, data)) {
+			LOGERROR("Unable to append to {}", file.string());
+			return;
+		}
+
+		if (cacheLines) {
+			index->hashes.insert(lineHash);
+			index->endsWithNewline = true;
+			index->fileSize        = fs::file_size(file, ec);
+			index->writeTime       = fs::last_write_time(file, ec);
+		}
+
+		LOG("Added line to {}: \"{}\"", fileName, line);
+	}
+} // namespace Files
+
+#if !defined(NO_JSON) && !defined(NO_BAKKESMOD)
+namespace PluginUpdates {
+	// global state for all the PluginUpdates:: functions. Can turn all this into a class maybe ong frfr
+	PluginUpdaterInfo pluginUpdaterInfo;
+	PluginUpdateInfo  updateInfo;
+	std::mutex        updateMutex;
+
+	/*
+	    - Will populate updateInfo with the necessary data
+	    - This update check only works if the github release name contains the version number. Like: "v1.2.3" or "Custom Thing v2.1.4" etc.
+	*/
+	void checkForUpdates(const std::string &modName, const std::string &currentVersion, const std::string &assetName) {
+		CurlRequest       req;
+		const std::string repoName = getRepoName(modName);
+		req.url                    = std::format("https://api.github.com/repos/smallest-cock/{}/releases/latest", repoName);
+		LOG("Checking for updates using this URL: {}", req.url);
+		HttpWrapper::SendCurlRequest(req, [modName, currentVersion, assetName](int code, std::string result) {
+			if (code != 200) {
+				LOGERROR("Invalid HTTP code: {}. Update check failed!", code);
+				return;
+			}
+
+			// straight into the fields that are used, the rest of the (large) response is skipped
+			auto release = Helper::getFromJsonStr<GitHubRelease>(result);
+			if (!release)
+				return;
+
+			std::string assetFileName = (assetName.empty() ? modName : assetName) + ".zip";
+			auto        updateInfoOpt = getUpdateInfo(*release, assetFileName);
+			if (!updateInfoOpt)
+				return;
+
+			PluginUpdateInfo &info = *updateInfoOpt;
+			info.pluginName        = modName;
+			info.outOfDate         = currentVersion != info.latestVersion;
+
+			{
+				std::lock_guard<std::mutex> lock(updateMutex);
+				updateInfo = info;
+			}
+
+			if (info.outOfDate)
+				LOG("New version available: {}", info.latestVersion);
+			else
+				LOG("Plugin is up to date: {}", currentVersion);
+		});
+	}
+
+	std::string getRepoName(const std::string &modName) {
+		// handle edge case bc CBO repo name isnt PascalCase like the other plugin repos
+		// ... and I dont know what side effects changing the repo name would have, smh bitch
+		if (modName == "CustomBallOnline")
+			return "Custom-Ball-Online";
+
+		return modName;
+	}
+
+	// the high level plugin-facing function
+	void installUpdate(const std::shared_ptr<GameWrapper> &gw) {
+		const std::string updateCmd = pluginUpdaterInfo.makeUpdateCmd(updateInfo);
+
+		// check if PluginUpdater's cvar exists (aka if the plugin is loaded)
+		if (_globalCvarManager->getCvar(pluginUpdaterInfo.existenceCheckCvar))
 			_globalCvarManager->executeCommand(updateCmd);
 		else {
 			LOG("{} doesn't seem to be loaded", pluginUpdaterInfo.prettyName);
@@ -851,11 +3820,11 @@ namespace PluginUpdates {
 					return;
 				}
 
-				auto responseJsonOpt = Helper::getJsonFromStr(result);
-				if (!responseJsonOpt)
+				auto release = Helper::getFromJsonStr<GitHubRelease>(result);
+				if (!release)
 					return;
 
-				auto urlOpt = getAssetDownloadUrl(*responseJsonOpt, pluginUpdaterInfo.assetName);
+				auto urlOpt = getAssetDownloadUrl(*release, pluginUpdaterInfo.assetName);
 				if (!urlOpt)
 					return;
 
@@ -882,7 +3851,7 @@ namespace PluginUpdates {
 					    // Add line to plugins.cfg
 					    LOG("Adding line to plugins.cfg...");
 					    const std::string pluginLoadCmd = pluginUpdaterInfo.makePluginLoadCmd();
-					    Files::appendLineIfNotExist(configFile, pluginLoadCmd);
+					    Files::appendLineIfNotExist(configFile, pluginLoadCmd, true);
 
 					    // this works bc "plugin load X" will wait until the plugin has fully loaded before executing the next command
 					    // ... otherwise, we would've had to do cvar probing in a new thread or something
@@ -920,19 +3889,51 @@ namespace PluginUpdates {
 		return std::nullopt;
 	}
 
+	namespace {
+		std::optional<std::string> versionFromReleaseName(const std::string &releaseName) {
+			constexpr auto          versionPattern = R"(v?(\d+\.\d+\.\d+(?:[-\w\.]+)?))";
+			static const std::regex re{versionPattern};
+			std::smatch             match;
+
+			if (std::regex_search(releaseName, match, re))
+				return match[1].str();
+			else {
+				LOGERROR("Release name \"{}\" doesn't match regex pattern: \"{}\"", releaseName, versionPattern);
+				return std::nullopt;
+			}
+		}
+	} // namespace
+
 	std::optional<std::string> getVersionStr(const json &releaseJson) {
-		constexpr auto          versionPattern = R"(v?(\d+\.\d+\.\d+(?:[-\w\.]+)?))";
-		static const std::regex re{versionPattern};
-		std::smatch             match;
+		return versionFromReleaseName(releaseJson["name"].get<std::string>());
+	}
 
-		auto releaseName = releaseJson["name"].get<std::string>();
-		if (std::regex_search(releaseName, match, re))
-			return match[1].str();
-		else {
-			LOGERROR("Release name \"{}\" doesn't match regex pattern: \"{}\"", releaseName, versionPattern);
+	std::optional<PluginUpdateInfo> getUpdateInfo(const GitHubRelease &release, const std::string &assetName) {
+		PluginUpdateInfo info{};
+
+		auto versionStr = getVersionStr(release);
+		if (!versionStr)
+			return std::nullopt;
+		info.latestVersion = *versionStr;
+
+		auto assetDownloadUrl = getAssetDownloadUrl(release, assetName);
+		if (!assetDownloadUrl)
 			return std::nullopt;
+		info.assetDownloadUrl = *assetDownloadUrl;
+
+		info.releaseUrl = release.html_url;
+		return info;
+	}
+
+	std::optional<std::string> getAssetDownloadUrl(const GitHubRelease &release, const std::string &assetName) {
+		for (const auto &asset : release.assets) {
+			if (asset.name == assetName)
+				return asset.browser_download_url;
 		}
+		return std::nullopt;
 	}
+
+	std::optional<std::string> getVersionStr(const GitHubRelease &release) { return versionFromReleaseName(release.name); }
 } // namespace PluginUpdates
 #endif
 namespace Process {
@@ -946,171 +3947,840 @@ namespace Process {
 		}
 	}
 
-	void terminate(HANDLE h) {
-		if (h != NULL && h != INVALID_HANDLE_VALUE) {
-			if (!TerminateProcess(h, 1)) {
-				LOG("TerminateProcess failed with error: {}", GetLastError());
-			}
-		} else {
-			LOG("Unable to terminate process. The handle is NULL or an invalid value");
+	void terminate(HANDLE h) {
+		if (h != NULL && h != INVALID_HANDLE_VALUE) {
+			if (!TerminateProcess(h, 1)) {
+				LOG("TerminateProcess failed with error: {}", GetLastError());
+			}
+		} else {
+			LOG("Unable to terminate process. The handle is NULL or an invalid value");
+		}
+	}
+
+	void terminate_created_process(ProcessHandles &pi) {
+		terminate(pi.hProcess);
+		close_handle(pi.hProcess);
+		close_handle(pi.hThread);
+	}
+
+	CreateProcessResult create_process_from_command(const std::string &command) {
+		// CreateProcess variables
+		STARTUPINFO         si;
+		PROCESS_INFORMATION pi;
+
+		// Initialize STARTUPINFO & PROCESS_INFORMATION
+		ZeroMemory(&si, sizeof(si));
+		si.cb = sizeof(si);
+		ZeroMemory(&pi, sizeof(pi));
+
+		std::wstring wide_command = Format::ToWideString(command);
+
+		// initialize result
+		CreateProcessResult result;
+
+		// Create the process to start python script
+		if (CreateProcessW(NULL,     // Application name (set NULL to use command)
+		        wide_command.data(), // Command
+		        NULL,                // Process security attributes
+		        NULL,                // Thread security attributes
+		        FALSE,               // Inherit handles from the calling process
+		        CREATE_NEW_CONSOLE,  // Creation flags (use CREATE_NEW_CONSOLE for async execution)
+		        NULL,                // Use parent's environment block
+		        NULL,                // Use parent's starting directory
+		        &si,                 // Pointer to STARTUPINFO
+		        &pi                  // Pointer to PROCESS_INFORMATION
+		        )) {
+			// Duplicate process handle so it remains valid even after original PROCESS_INFORMATION goes out of scope
+			HANDLE duplicatedProcessHandle = NULL;
+			HANDLE duplicatedThreadHandle  = NULL;
+
+			if (DuplicateHandle(
+			        GetCurrentProcess(), pi.hProcess, GetCurrentProcess(), &duplicatedProcessHandle, 0, FALSE, DUPLICATE_SAME_ACCESS) &&
+			    DuplicateHandle(
+			        GetCurrentProcess(), pi.hThread, GetCurrentProcess(), &duplicatedThreadHandle, 0, FALSE, DUPLICATE_SAME_ACCESS)) {
+				result.handles.hProcess = duplicatedProcessHandle;
+				result.handles.hThread  = duplicatedThreadHandle;
+			} else {
+				result.status_code = GetLastError();
+			}
+
+			CloseHandle(pi.hProcess);
+			CloseHandle(pi.hThread);
+		} else {
+			// If CreateProcess failed, return the error code
+			result.status_code = GetLastError();
+		}
+
+		return result;
+	}
+} // namespace Process
+
+#ifndef NO_RLSDK
+namespace Colors {
+	// returns a AARRGGBB packed 32-bit int
+	uint32_t packColor(const FColor &col) {
+		return (static_cast<uint32_t>(col.A) << 24) | (static_cast<uint32_t>(col.R) << 16) | (static_cast<uint32_t>(col.G) << 8) |
+		       static_cast<uint32_t>(col.B);
+	}
+
+	// expects a AARRGGBB packed 32-bit int
+	FColor unpackColor(uint32_t packed) {
+		return {
+		    static_cast<uint8_t>(packed & 0xFF),         // B
+		    static_cast<uint8_t>((packed >> 8) & 0xFF),  // G
+		    static_cast<uint8_t>((packed >> 16) & 0xFF), // R
+		    static_cast<uint8_t>((packed >> 24) & 0xFF)  // A
+		};
+	}
+
+	// FColor --> AARRGGBB hex string
+	std::string fcolorToHex(const FColor &col) {
+		uint32_t           packedInt = packColor(col);
+		std::ostringstream ss;
+		ss << std::hex << std::uppercase << std::setfill('0') << std::setw(8) << packedInt;
+		return ss.str();
+	}
+
+	// AARRGGBB hex string --> FColor
+	std::optional<FColor> hexToFColor(const std::string &hex) {
+		if (hex.size() != 8) {
+			LOG("ERROR: Color hex string \"{}\" isn't 8 characters. Falling back to white...");
+			return FColor{255, 255, 255, 255}; // fallback to white
+		}
+
+		std::optional<Color> color = parseHex(hex, HexFormat::ARGB);
+		if (!color) {
+			LOGERROR("Invalid FColor hex string: \"{}\"", hex);
+			return std::nullopt;
+		}
+
+		return color->UnrealColor();
+	}
+
+	namespace {
+		// hex digit value, or 0xFF for anything that isn't a hex digit
+		constexpr std::array<uint8_t, 256> hexDigitLUT = [] {
+			std::array<uint8_t, 256> lut{};
+			for (size_t c = 0; c < lut.size(); ++c) {
+				if (c >= '0' && c <= '9')
+					lut[c] = static_cast<uint8_t>(c - '0');
+				else if (c >= 'a' && c <= 'f')
+					lut[c] = static_cast<uint8_t>(c - 'a' + 10);
+				else if (c >= 'A' && c <= 'F')
+					lut[c] = static_cast<uint8_t>(c - 'A' + 10);
+				else
+					lut[c] = 0xFF;
+			}
+			return lut;
+		}();
+
+		// parses exactly digits.size() hex digits (at most 8), any invalid digit sets bit 8+ of the OR'd value
+		bool parseHexDigits(std::string_view digits, uint32_t &out) noexcept {
+			uint32_t value   = 0;
+			uint32_t invalid = 0;
+			for (char c : digits) {
+				const uint8_t nibble = hexDigitLUT[static_cast<unsigned char>(c)];
+				invalid |= nibble;
+				value = (value << 4) | (nibble & 0xF);
+			}
+			out = value;
+			return invalid <= 0xF;
+		}
+	} // namespace
+
+	std::optional<Color> parseHex(std::string_view hex, HexFormat format) noexcept {
+		size_t digits = 8;
+
+		switch (format) {
+		case HexFormat::RGB:
+			digits = 6;
+			[[fallthrough]];
+		case HexFormat::RGBA:
+			if (!hex.empty() && hex.front() == '#')
+				hex.remove_prefix(1);
+			break;
+		case HexFormat::PrefixedRGBA:
+			if (hex.size() < 2 || hex[0] != '0' || (hex[1] != 'x' && hex[1] != 'X'))
+				return std::nullopt;
+			hex.remove_prefix(2);
+			break;
+		case HexFormat::ARGB: break;
+		default: return std::nullopt;
+		}
+
+		uint32_t value = 0;
+		if (hex.size() != digits || !parseHexDigits(hex, value))
+			return std::nullopt;
+
+		// normalize to 0xRRGGBBAA
+		if (format == HexFormat::RGB)
+			value = (value << 8) | 0xFF;
+		else if (format == HexFormat::ARGB)
+			value = std::rotl(value, 8);
+
+		return Color(static_cast<uint8_t>(value >> 24),
+		    static_cast<uint8_t>(value >> 16),
+		    static_cast<uint8_t>(value >> 8),
+		    static_cast<uint8_t>(value));
+	}
+
+	size_t parseHexBatch(const std::string_view *src, Color *dst, size_t count, HexFormat format, Color fallback) noexcept {
+		size_t parsed = 0;
+		for (size_t i = 0; i < count; ++i) {
+			const std::optional<Color> color = parseHex(src[i], format);
+			dst[i]                           = color.value_or(fallback);
+			parsed += color.has_value();
+		}
+		return parsed;
+	}
+
+#ifndef NO_BAKKESMOD
+	FLinearColor CvarColorToFLinearColor(const LinearColor &cvarColor) {
+		LinearColor fixedCol = cvarColor / 255;
+
+		return FLinearColor{fixedCol.R, fixedCol.G, fixedCol.B, fixedCol.A};
+	}
+
+	uint32_t CvarColorToInt(const LinearColor &col) { return FLinearColorToInt(CvarColorToFLinearColor(col)); }
+#endif
+
+	int32_t FLinearColorToInt(const FLinearColor &color) {
+		FColor fColor = fLinearColorToFColor(color);
+		return Color(fColor).ToDecimal();
+	}
+
+	std::string fcolorToHexRGBA(const FColor &col) {
+		std::stringstream ss;
+		ss << "0x" << std::uppercase << std::setfill('0') << std::hex << std::setw(2) << static_cast<int>(col.R) << std::setw(2)
+		   << static_cast<int>(col.G) << std::setw(2) << static_cast<int>(col.B) << std::setw(2) << static_cast<int>(col.A);
+		return ss.str();
+	}
+
+	// throws for compatibility with existing callers, use parseHex(hex, HexFormat::PrefixedRGBA) to avoid exceptions
+	FColor hexRGBAtoFColor(const std::string &hex) {
+		std::optional<Color> color = parseHex(hex, HexFormat::PrefixedRGBA);
+		if (!color)
+			throw std::invalid_argument("Invalid color hex string format. Expected format: 0xRRGGBBAA");
+
+		return color->UnrealColor();
+	}
+
+	// the batch kernels treat all of these as plain arrays of 4 channels
+	static_assert(sizeof(FLinearColor) == 4 * sizeof(float) && sizeof(CoolerLinearColor) == 4 * sizeof(float));
+	static_assert(sizeof(FColor) == 4 && sizeof(Color) == 4);
+
+	namespace {
+		const std::array<float, 256> &srgbToLinearLUT() {
+			static const auto lut = [] {
+				std::array<float, 256> table{};
+				for (size_t i = 0; i < table.size(); ++i) {
+					float c  = i / 255.0f;
+					table[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+				}
+				return table;
+			}();
+			return lut;
+		}
+
+		// 14-bit input precision keeps every output within 1 of the exact rounded value, even on the steep part of the curve
+		constexpr size_t linearToSrgbLUTSize = 1 << 14;
+
+		const std::array<uint8_t, linearToSrgbLUTSize> &linearToSrgbLUT() {
+			static const auto lut = [] {
+				std::array<uint8_t, linearToSrgbLUTSize> table{};
+				for (size_t i = 0; i < table.size(); ++i) {
+					float l  = static_cast<float>(i) / (linearToSrgbLUTSize - 1);
+					float c  = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+					table[i] = static_cast<uint8_t>(std::lround(std::clamp(c, 0.0f, 1.0f) * 255.0f));
+				}
+				return table;
+			}();
+			return lut;
+		}
+
+		// NaN goes to 0 (std::clamp would pass it through), same as the SSE2 path's max/min
+		float clampNaN(float v, float hi) { return !(v > 0.0f) ? 0.0f : std::min(v, hi); }
+
+		uint8_t quantize(float v, const BatchOptions &opts) {
+			v *= 255.0f;
+			if (opts.clamp)
+				v = clampNaN(v, 255.0f);
+			else if (!std::isfinite(v))
+				return 0;
+			v = opts.rounding == BatchOptions::Rounding::Nearest ? std::round(v) : std::trunc(v);
+
+			// reduce modulo 256 before the int cast, which is undefined outside int32 range. fmod is exact, and the result keeps v's
+			// sign, so negative values wrap the same way a two's complement low byte does
+			return static_cast<uint8_t>(static_cast<int32_t>(std::fmod(v, 256.0f)));
+		}
+
+		uint8_t encodeSrgb(float v) {
+			const auto &lut = linearToSrgbLUT();
+			return lut[static_cast<size_t>(clampNaN(v, 1.0f) * (linearToSrgbLUTSize - 1) + 0.5f)];
+		}
+
+		// src is RGBA floats. dst is RGBA bytes, or BGRA when swapRB is set (FColor layout)
+		template <bool swapRB>
+		void floatsToBytes(const float *src, uint8_t *dst, size_t count, const BatchOptions &opts) {
+			constexpr size_t r = swapRB ? 2 : 0;
+			constexpr size_t b = swapRB ? 0 : 2;
+			size_t           i = 0;
+
+#ifdef MODUTILS_SSE2
+			if (!opts.sRGB) {
+				const __m128  scale     = _mm_set1_ps(255.0f);
+				const __m128  zero      = _mm_setzero_ps();
+				const __m128  one       = _mm_set1_ps(1.0f);
+				const __m128  half      = _mm_set1_ps(0.5f);
+				const __m128  signMask  = _mm_set1_ps(-0.0f);
+				const __m128  alphaLane = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+				const __m128i byteMask  = _mm_set1_epi32(0xFF);
+				const bool    nearest   = opts.rounding == BatchOptions::Rounding::Nearest;
+
+				auto toInts = [&](const float *pixel) {
+					__m128 px = _mm_loadu_ps(pixel);
+					if (opts.clamp)
+						px = _mm_min_ps(_mm_max_ps(px, zero), one);
+					if (opts.premultipliedAlpha) {
+						const __m128 alpha = _mm_shuffle_ps(px, px, _MM_SHUFFLE(3, 3, 3, 3));
+						px = _mm_mul_ps(px, _mm_or_ps(_mm_andnot_ps(alphaLane, alpha), _mm_and_ps(alphaLane, one))); // (a, a, a, 1)
+					}
+					if constexpr (swapRB)
+						px = _mm_shuffle_ps(px, px, _MM_SHUFFLE(3, 0, 1, 2));
+
+					px = _mm_mul_ps(px, scale);
+					if (nearest) {
+						// std::round, done exactly: truncate, then step away from zero when the dropped fraction is >= 0.5. Adding
+						// +-0.5 first isn't exact (0.49999997f + 0.5f rounds up to 1.0f)
+						const __m128 whole = _mm_cvtepi32_ps(_mm_cvttps_epi32(px));
+						const __m128 frac  = _mm_andnot_ps(signMask, _mm_sub_ps(px, whole));
+						const __m128 step  = _mm_or_ps(one, _mm_and_ps(px, signMask)); // +-1 with the sign of px
+						px                 = _mm_add_ps(whole, _mm_and_ps(_mm_cmpge_ps(frac, half), step));
+					}
+					__m128i ints = _mm_cvttps_epi32(px);
+					return opts.clamp ? ints : _mm_and_si128(ints, byteMask);
+				};
+
+				for (; i + 4 <= count; i += 4) {
+					const __m128i p01 = _mm_packs_epi32(toInts(src + i * 4), toInts(src + i * 4 + 4));
+					const __m128i p23 = _mm_packs_epi32(toInts(src + i * 4 + 8), toInts(src + i * 4 + 12));
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), _mm_packus_epi16(p01, p23));
+				}
+			}
+#endif
+			for (; i < count; ++i) {
+				const float *in  = src + i * 4;
+				uint8_t     *out = dst + i * 4;
+
+				float alpha = opts.clamp ? std::clamp(in[3], 0.0f, 1.0f) : in[3];
+				float rgb[3];
+				for (size_t c = 0; c < 3; ++c) {
+					rgb[c] = opts.clamp ? std::clamp(in[c], 0.0f, 1.0f) : in[c];
+					if (opts.premultipliedAlpha)
+						rgb[c] *= alpha;
+				}
+
+				if (opts.sRGB) {
+					out[r] = encodeSrgb(rgb[0]);
+					out[1] = encodeSrgb(rgb[1]);
+					out[b] = encodeSrgb(rgb[2]);
+				} else {
+					out[r] = quantize(rgb[0], opts);
+					out[1] = quantize(rgb[1], opts);
+					out[b] = quantize(rgb[2], opts);
+				}
+				out[3] = quantize(alpha, opts);
+			}
+		}
+
+		// src is RGBA bytes, or BGRA when swapRB is set (FColor layout). dst is RGBA floats
+		template <bool swapRB>
+		void bytesToFloats(const uint8_t *src, float *dst, size_t count, const BatchOptions &opts) {
+			constexpr size_t r = swapRB ? 2 : 0;
+			constexpr size_t b = swapRB ? 0 : 2;
+			size_t           i = 0;
+
+#ifdef MODUTILS_SSE2
+			if (!opts.sRGB) {
+				const __m128i zero      = _mm_setzero_si128();
+				const __m128  scale     = _mm_set1_ps(255.0f);
+				const __m128  alphaLane = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+
+				auto store = [&](__m128i ints, float *out) {
+					__m128 px = _mm_div_ps(_mm_cvtepi32_ps(ints), scale); // divide (not multiply by 1/255) to match fColorToFLinearColor
+					if constexpr (swapRB)
+						px = _mm_shuffle_ps(px, px, _MM_SHUFFLE(3, 0, 1, 2));
+					if (opts.premultipliedAlpha) {
+						const __m128 alpha    = _mm_shuffle_ps(px, px, _MM_SHUFFLE(3, 3, 3, 3));
+						const __m128 nonZero  = _mm_cmpneq_ps(alpha, _mm_setzero_ps());
+						const __m128 unpremul = _mm_and_ps(_mm_div_ps(px, alpha), nonZero);
+						px                    = _mm_or_ps(_mm_andnot_ps(alphaLane, unpremul), _mm_and_ps(alphaLane, px));
+					}
+					_mm_storeu_ps(out, px);
+				};
+
+				for (; i + 4 <= count; i += 4) {
+					const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4));
+					const __m128i lo    = _mm_unpacklo_epi8(bytes, zero);
+					const __m128i hi    = _mm_unpackhi_epi8(bytes, zero);
+					store(_mm_unpacklo_epi16(lo, zero), dst + i * 4);
+					store(_mm_unpackhi_epi16(lo, zero), dst + i * 4 + 4);
+					store(_mm_unpacklo_epi16(hi, zero), dst + i * 4 + 8);
+					store(_mm_unpackhi_epi16(hi, zero), dst + i * 4 + 12);
+				}
+			}
+#endif
+			const auto &srgbLut = srgbToLinearLUT();
+			for (; i < count; ++i) {
+				const uint8_t *in  = src + i * 4;
+				float         *out = dst + i * 4;
+
+				if (opts.sRGB) {
+					out[0] = srgbLut[in[r]];
+					out[1] = srgbLut[in[1]];
+					out[2] = srgbLut[in[b]];
+				} else {
+					out[0] = static_cast<float>(in[r]) / 255.0f;
+					out[1] = static_cast<float>(in[1]) / 255.0f;
+					out[2] = static_cast<float>(in[b]) / 255.0f;
+				}
+				out[3] = static_cast<float>(in[3]) / 255.0f;
+
+				if (opts.premultipliedAlpha) {
+					for (size_t c = 0; c < 3; ++c)
+						out[c] = out[3] != 0.0f ? out[c] / out[3] : 0.0f;
+				}
+			}
+		}
+	} // namespace
+
+	namespace {
+		void swizzleScalar(const uint8_t *src, uint8_t *dst, size_t numPixels, const SwizzleSpec &spec) {
+			for (size_t i = 0; i < numPixels; ++i) {
+				// copy the pixel first so in-place swizzles don't read channels that were already overwritten
+				uint8_t pixel[4];
+				std::memcpy(pixel, src + i * spec.srcChannels, spec.srcChannels);
+
+				uint8_t *out = dst + i * spec.dstChannels;
+				for (size_t c = 0; c < spec.dstChannels; ++c)
+					out[c] = spec.dstOrder[c] == swizzleFill ? spec.fillValue : pixel[spec.dstOrder[c]];
+			}
+		}
+
+#ifdef MODUTILS_SSSE3
+		// Builds the pshufb control + fill bytes for one 16-byte block and returns how many pixels that block covers
+		size_t buildShuffle(const SwizzleSpec &spec, uint8_t (&mask)[16], uint8_t (&fill)[16]) {
+			const size_t pixels = (spec.srcChannels == 3 && spec.dstChannels == 3) ? 5 : 4;
+
+			for (size_t byte = 0; byte < 16; ++byte) {
+				// bytes past the last whole pixel pass through when the layout is unchanged, and are zeroed otherwise (they get
+				// overwritten by the next block anyway)
+				mask[byte] = spec.srcChannels == spec.dstChannels ? static_cast<uint8_t>(byte) : 0x80;
+				fill[byte] = 0;
+			}
+
+			for (size_t p = 0; p < pixels; ++p) {
+				for (size_t c = 0; c < spec.dstChannels; ++c) {
+					const size_t  byte = p * spec.dstChannels + c;
+					const uint8_t from = spec.dstOrder[c];
+					mask[byte]         = from == swizzleFill ? 0x80 : static_cast<uint8_t>(p * spec.srcChannels + from);
+					fill[byte]         = from == swizzleFill ? spec.fillValue : 0;
+				}
+			}
+			return pixels;
+		}
+#endif
+	} // namespace
+
+	void swizzle(const uint8_t *src, uint8_t *dst, size_t numPixels, const SwizzleSpec &spec) {
+		if ((spec.srcChannels != 3 && spec.srcChannels != 4) || (spec.dstChannels != 3 && spec.dstChannels != 4)) {
+			LOGERROR("Unsupported swizzle: {} --> {} channels", spec.srcChannels, spec.dstChannels);
+			return;
+		}
+
+		size_t i = 0;
+
+#if defined(MODUTILS_SSSE3)
+		uint8_t maskBytes[16], fillBytes[16];
+		const size_t blockPixels = buildShuffle(spec, maskBytes, fillBytes);
+		const __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i *>(maskBytes));
+		const __m128i fill = _mm_loadu_si128(reinterpret_cast<const __m128i *>(fillBytes));
+
+#ifdef MODUTILS_AVX2
+		if (spec.srcChannels == 4 && spec.dstChannels == 4) {
+			const __m256i mask256 = _mm256_broadcastsi128_si256(mask); // vpshufb shuffles within each 128-bit lane
+			const __m256i fill256 = _mm256_broadcastsi128_si256(fill);
+			for (; i + 8 <= numPixels; i += 8) {
+				const __m256i px = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i * 4));
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i * 4), _mm256_or_si256(_mm256_shuffle_epi8(px, mask256), fill256));
+			}
+		}
+#endif
+		// every block reads and writes a full 16 bytes, so stop while both buffers still have that much room
+		const size_t srcBytes = numPixels * spec.srcChannels;
+		const size_t dstBytes = numPixels * spec.dstChannels;
+		for (; i * spec.srcChannels + 16 <= srcBytes && i * spec.dstChannels + 16 <= dstBytes; i += blockPixels) {
+			const __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * spec.srcChannels));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * spec.dstChannels), _mm_or_si128(_mm_shuffle_epi8(px, mask), fill));
+		}
+#elif defined(MODUTILS_SSE2)
+		if (spec.srcChannels == 4 && spec.dstChannels == 4) {
+			// no byte shuffle in SSE2, so move each channel into place with 32-bit lane shifts
+			const __m128i lowByte = _mm_set1_epi32(0xFF);
+			__m128i       fill    = _mm_setzero_si128();
+			__m128i       srcShift[4], dstShift[4];
+			bool          fromSrc[4];
+			for (size_t c = 0; c < 4; ++c) {
+				fromSrc[c]  = spec.dstOrder[c] != swizzleFill;
+				srcShift[c] = _mm_cvtsi32_si128(fromSrc[c] ? spec.dstOrder[c] * 8 : 0);
+				dstShift[c] = _mm_cvtsi32_si128(static_cast<int>(c * 8));
+				if (!fromSrc[c])
+					fill = _mm_or_si128(fill, _mm_sll_epi32(_mm_set1_epi32(spec.fillValue), dstShift[c]));
+			}
+
+			for (; i + 4 <= numPixels; i += 4) {
+				const __m128i px  = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4));
+				__m128i       out = fill;
+				for (size_t c = 0; c < 4; ++c) {
+					if (fromSrc[c])
+						out = _mm_or_si128(out, _mm_sll_epi32(_mm_and_si128(_mm_srl_epi32(px, srcShift[c]), lowByte), dstShift[c]));
+				}
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), out);
+			}
+		}
+#endif
+		swizzleScalar(src + i * spec.srcChannels, dst + i * spec.dstChannels, numPixels - i, spec);
+	}
+
+	void swizzleParallel(const uint8_t *src, uint8_t *dst, size_t numPixels, const SwizzleSpec &spec, size_t numThreads) {
+		constexpr size_t tilePixels = 64 * 1024; // 256 KB of RGBA per tile, small enough to stay in L2
+
+		Helper::parallelFor(
+		    numPixels,
+		    tilePixels,
+		    [&](size_t begin, size_t end) {
+			    for (size_t tile = begin; tile < end; tile += tilePixels) {
+				    const size_t count = std::min(tilePixels, end - tile);
+				    swizzle(src + tile * spec.srcChannels, dst + tile * spec.dstChannels, count, spec);
+			    }
+		    },
+		    numThreads);
+	}
+
+	namespace {
+		// round(a * b / 255) for a, b in [0, 255], without a division
+		inline uint8_t mulDiv255(uint32_t a, uint32_t b) {
+			const uint32_t product = a * b + 128;
+			return static_cast<uint8_t>((product + (product >> 8)) >> 8);
+		}
+	} // namespace
+
+	PixelPipeline &PixelPipeline::Swizzle(const SwizzleSpec &spec) {
+		if (spec.srcChannels != 4 || spec.dstChannels != 4) {
+			LOGERROR("PixelPipeline only supports 4 --> 4 channel swizzles");
+			return *this;
+		}
+
+		std::array<uint8_t, 4> layout;
+		for (size_t i = 0; i < 4; ++i)
+			layout[i] = spec.dstOrder[i] == swizzleFill ? swizzleFill : m_layout[spec.dstOrder[i]];
+		m_layout = layout;
+
+		m_stages.push_back({Stage::Type::Swizzle, spec});
+		return *this;
+	}
+
+	PixelPipeline &PixelPipeline::Tint(const Color &tint) {
+		const uint8_t logical[4] = {tint.R, tint.G, tint.B, tint.A};
+
+		Stage stage{Stage::Type::Multiply};
+		for (size_t i = 0; i < 4; ++i)
+			stage.factors[i] = m_layout[i] == swizzleFill ? 255 : logical[m_layout[i]]; // filled channels are left alone
+		m_stages.push_back(std::move(stage));
+		return *this;
+	}
+
+	PixelPipeline &PixelPipeline::Premultiply() {
+		const auto alpha = std::find(m_layout.begin(), m_layout.end(), uint8_t{3});
+		if (alpha == m_layout.end()) {
+			LOGERROR("PixelPipeline can't premultiply, the alpha channel was swizzled away");
+			return *this;
 		}
+
+		Stage stage{Stage::Type::Premultiply};
+		stage.factors[0] = static_cast<uint8_t>(alpha - m_layout.begin());
+		m_stages.push_back(std::move(stage));
+		return *this;
 	}
 
-	void terminate_created_process(ProcessHandles &pi) {
-		terminate(pi.hProcess);
-		close_handle(pi.hProcess);
-		close_handle(pi.hThread);
+	PixelPipeline &PixelPipeline::Custom(CustomStage stage) {
+		m_stages.push_back({Stage::Type::Custom, {}, {}, std::move(stage)});
+		return *this;
 	}
 
-	CreateProcessResult create_process_from_command(const std::string &command) {
-		// CreateProcess variables
-		STARTUPINFO         si;
-		PROCESS_INFORMATION pi;
+	PixelPipeline &PixelPipeline::Conversion(const BatchOptions &opts) {
+		m_conversion = opts;
+		return *this;
+	}
 
-		// Initialize STARTUPINFO & PROCESS_INFORMATION
-		ZeroMemory(&si, sizeof(si));
-		si.cb = sizeof(si);
-		ZeroMemory(&pi, sizeof(pi));
+	void PixelPipeline::Clear() {
+		m_stages.clear();
+		m_layout     = {0, 1, 2, 3};
+		m_conversion = {};
+	}
 
-		std::wstring wide_command = StringUtils::ToWideString(command);
+	void PixelPipeline::RunStages(uint8_t *rgba, size_t numPixels) const {
+		for (const Stage &stage : m_stages) {
+			switch (stage.type) {
+			case Stage::Type::Swizzle: swizzle(rgba, rgba, numPixels, stage.swizzle); break;
+			case Stage::Type::Multiply:
+				// plain byte loop, simple enough for the compiler to vectorize
+				for (size_t i = 0; i < numPixels * 4; ++i)
+					rgba[i] = mulDiv255(rgba[i], stage.factors[i & 3]);
+				break;
+			case Stage::Type::Premultiply: {
+				const size_t alpha = stage.factors[0];
+				for (size_t i = 0; i < numPixels; ++i) {
+					uint8_t       *pixel = rgba + i * 4;
+					const uint32_t a     = pixel[alpha];
+					for (size_t c = 0; c < 4; ++c) {
+						if (c != alpha)
+							pixel[c] = mulDiv255(pixel[c], a);
+					}
+				}
+				break;
+			}
+			case Stage::Type::Custom: stage.custom(rgba, numPixels); break;
+			}
+		}
+	}
 
-		// initialize result
-		CreateProcessResult result;
+	void PixelPipeline::Run(const uint8_t *src, uint8_t *dst, size_t numPixels, size_t numThreads) const {
+		Helper::parallelFor(
+		    numPixels,
+		    tilePixels * 4,
+		    [&](size_t begin, size_t end) {
+			    for (size_t tile = begin; tile < end; tile += tilePixels) {
+				    const size_t count = std::min(tilePixels, end - tile);
+				    if (src != dst)
+					    std::memcpy(dst + tile * 4, src + tile * 4, count * 4);
+				    RunStages(dst + tile * 4, count);
+			    }
+		    },
+		    numThreads);
+	}
 
-		// Create the process to start python script
-		if (CreateProcessW(NULL,     // Application name (set NULL to use command)
-		        wide_command.data(), // Command
-		        NULL,                // Process security attributes
-		        NULL,                // Thread security attributes
-		        FALSE,               // Inherit handles from the calling process
-		        CREATE_NEW_CONSOLE,  // Creation flags (use CREATE_NEW_CONSOLE for async execution)
-		        NULL,                // Use parent's environment block
-		        NULL,                // Use parent's starting directory
-		        &si,                 // Pointer to STARTUPINFO
-		        &pi                  // Pointer to PROCESS_INFORMATION
-		        )) {
-			// Duplicate process handle so it remains valid even after original PROCESS_INFORMATION goes out of scope
-			HANDLE duplicatedProcessHandle = NULL;
-			HANDLE duplicatedThreadHandle  = NULL;
+	void PixelPipeline::Run(const FLinearColor *src, uint8_t *dst, size_t numPixels, size_t numThreads) const {
+		Helper::parallelFor(
+		    numPixels,
+		    tilePixels * 4,
+		    [&](size_t begin, size_t end) {
+			    for (size_t tile = begin; tile < end; tile += tilePixels) {
+				    const size_t count = std::min(tilePixels, end - tile);
+				    linearToRGBA8(src + tile, dst + tile * 4, count, m_conversion);
+				    RunStages(dst + tile * 4, count);
+			    }
+		    },
+		    numThreads);
+	}
 
-			if (DuplicateHandle(
-			        GetCurrentProcess(), pi.hProcess, GetCurrentProcess(), &duplicatedProcessHandle, 0, FALSE, DUPLICATE_SAME_ACCESS) &&
-			    DuplicateHandle(
-			        GetCurrentProcess(), pi.hThread, GetCurrentProcess(), &duplicatedThreadHandle, 0, FALSE, DUPLICATE_SAME_ACCESS)) {
-				result.handles.hProcess = duplicatedProcessHandle;
-				result.handles.hThread  = duplicatedThreadHandle;
-			} else {
-				result.status_code = GetLastError();
-			}
+	void PixelPipeline::Run(const uint8_t *src, FLinearColor *dst, size_t numPixels, size_t numThreads) const {
+		Helper::parallelFor(
+		    numPixels,
+		    tilePixels * 4,
+		    [&](size_t begin, size_t end) {
+			    alignas(16) uint8_t scratch[tilePixels * 4]; // the stages run here, so src is never written to
+			    for (size_t tile = begin; tile < end; tile += tilePixels) {
+				    const size_t count = std::min(tilePixels, end - tile);
+				    std::memcpy(scratch, src + tile * 4, count * 4);
+				    RunStages(scratch, count);
+				    rgba8ToLinear(scratch, dst + tile, count, m_conversion);
+			    }
+		    },
+		    numThreads);
+	}
 
-			CloseHandle(pi.hProcess);
-			CloseHandle(pi.hThread);
-		} else {
-			// If CreateProcess failed, return the error code
-			result.status_code = GetLastError();
-		}
+	void linearToFColors(const FLinearColor *src, FColor *dst, size_t count, const BatchOptions &opts) {
+		floatsToBytes<true>(reinterpret_cast<const float *>(src), reinterpret_cast<uint8_t *>(dst), count, opts);
+	}
 
-		return result;
+	void linearToRGBA8(const FLinearColor *src, uint8_t *dst, size_t count, const BatchOptions &opts) {
+		floatsToBytes<false>(reinterpret_cast<const float *>(src), dst, count, opts);
 	}
-} // namespace Process
 
-#ifndef NO_RLSDK
-namespace Colors {
-	// returns a AARRGGBB packed 32-bit int
-	uint32_t packColor(const FColor &col) {
-		return (static_cast<uint32_t>(col.A) << 24) | (static_cast<uint32_t>(col.R) << 16) | (static_cast<uint32_t>(col.G) << 8) |
-		       static_cast<uint32_t>(col.B);
+	void linearToColors(const CoolerLinearColor *src, Color *dst, size_t count, const BatchOptions &opts) {
+		floatsToBytes<false>(reinterpret_cast<const float *>(src), reinterpret_cast<uint8_t *>(dst), count, opts);
 	}
 
-	// expects a AARRGGBB packed 32-bit int
-	FColor unpackColor(uint32_t packed) {
-		return {
-		    static_cast<uint8_t>(packed & 0xFF),         // B
-		    static_cast<uint8_t>((packed >> 8) & 0xFF),  // G
-		    static_cast<uint8_t>((packed >> 16) & 0xFF), // R
-		    static_cast<uint8_t>((packed >> 24) & 0xFF)  // A
-		};
+	void fColorsToLinear(const FColor *src, FLinearColor *dst, size_t count, const BatchOptions &opts) {
+		bytesToFloats<true>(reinterpret_cast<const uint8_t *>(src), reinterpret_cast<float *>(dst), count, opts);
 	}
 
-	// FColor --> AARRGGBB hex string
-	std::string fcolorToHex(const FColor &col) {
-		uint32_t           packedInt = packColor(col);
-		std::ostringstream ss;
-		ss << std::hex << std::uppercase << std::setfill('0') << std::setw(8) << packedInt;
-		return ss.str();
+	void rgba8ToLinear(const uint8_t *src, FLinearColor *dst, size_t count, const BatchOptions &opts) {
+		bytesToFloats<false>(src, reinterpret_cast<float *>(dst), count, opts);
 	}
 
-	// AARRGGBB hex string --> FColor
-	std::optional<FColor> hexToFColor(const std::string &hex) {
-		if (hex.size() != 8) {
-			LOG("ERROR: Color hex string \"{}\" isn't 8 characters. Falling back to white...");
-			return FColor{255, 255, 255, 255}; // fallback to white
+	void colorsToLinear(const Color *src, CoolerLinearColor *dst, size_t count, const BatchOptions &opts) {
+		bytesToFloats<false>(reinterpret_cast<const uint8_t *>(src), reinterpret_cast<float *>(dst), count, opts);
+	}
+
+	// PaletteMatcher class
+	namespace {
+		float distanceSquared(const std::array<float, 3> &a, const std::array<float, 3> &b) {
+			const float x = a[0] - b[0], y = a[1] - b[1], z = a[2] - b[2];
+			return x * x + y * y + z * z;
 		}
+	} // namespace
 
-		uint32_t packed = 0xFFFFFFFF;
+	PaletteMatcher::PaletteMatcher(std::vector<Color> palette, const PaletteOptions &options) { Build(std::move(palette), options); }
 
-		try {
-			packed = static_cast<uint32_t>(std::stoul(hex, nullptr, 16));
-		} catch (std::exception &e) {
-			LOGERROR("Invalid FColor hex string passed to std::stoul: \"{}\"", hex);
-			LOGERROR("{}", e.what());
-			return std::nullopt;
-		}
+	std::array<float, 3> PaletteMatcher::ToOKLab(const Color &color) {
+		// https://bottosson.github.io/posts/oklab/
+		const auto &toLinear = srgbToLinearLUT();
+		const float r = toLinear[color.R], g = toLinear[color.G], b = toLinear[color.B];
+
+		const float l = std::cbrt(0.4122214708f * r + 0.5363325363f * g + 0.0514459929f * b);
+		const float m = std::cbrt(0.2119034982f * r + 0.6806995451f * g + 0.1073969566f * b);
+		const float s = std::cbrt(0.0883024619f * r + 0.2817188376f * g + 0.6299787005f * b);
 
-		return unpackColor(packed);
+		return {0.2104542553f * l + 0.7936177850f * m - 0.0040720468f * s,
+		    1.9779984951f * l - 2.4285922050f * m + 0.4505937099f * s,
+		    0.0259040371f * l + 0.7827717662f * m - 0.8086757660f * s};
 	}
 
-#ifndef NO_BAKKESMOD
-	FLinearColor CvarColorToFLinearColor(const LinearColor &cvarColor) {
-		LinearColor fixedCol = cvarColor / 255;
+	PaletteMatcher::Point PaletteMatcher::ToPoint(const Color &color) const {
+		Point point = m_options.metric == PaletteMetric::OKLab ? ToOKLab(color) : Point{float(color.R), float(color.G), float(color.B)};
+		for (size_t i = 0; i < 3; ++i)
+			point[i] *= m_options.weights[i];
+		return point;
+	}
 
-		return FLinearColor{fixedCol.R, fixedCol.G, fixedCol.B, fixedCol.A};
+	float PaletteMatcher::Distance(const Color &a, const Color &b) const { return std::sqrt(distanceSquared(ToPoint(a), ToPoint(b))); }
+
+	uint32_t PaletteMatcher::NearestOf(const Point &point, const uint16_t *candidates, size_t count) const {
+		uint32_t best         = npos;
+		float    bestDistance = std::numeric_limits<float>::max();
+		for (size_t i = 0; i < count; ++i) {
+			const uint32_t index    = candidates ? candidates[i] : static_cast<uint32_t>(i);
+			const float    distance = distanceSquared(point, m_points[index]);
+			if (distance < bestDistance) {
+				bestDistance = distance;
+				best         = index;
+			}
+		}
+		return best;
 	}
 
-	uint32_t CvarColorToInt(const LinearColor &col) { return FLinearColorToInt(CvarColorToFLinearColor(col)); }
-#endif
+	void PaletteMatcher::Build(std::vector<Color> palette, const PaletteOptions &options) {
+		if (palette.size() > UINT16_MAX) {
+			LOGERROR("PaletteMatcher palettes are limited to {} entries, got {}", UINT16_MAX, palette.size());
+			palette.resize(UINT16_MAX);
+		}
 
-	int32_t FLinearColorToInt(const FLinearColor &color) {
-		FColor fColor = fLinearColorToFColor(color);
-		return Color(fColor).ToDecimal();
-	}
+		m_palette          = std::move(palette);
+		m_options          = options;
+		m_options.gridBits = std::clamp<uint8_t>(m_options.gridBits, 1, 6);
+
+		m_points.clear();
+		for (const Color &color : m_palette)
+			m_points.push_back(ToPoint(color));
+
+		const uint32_t bits      = m_options.gridBits;
+		const uint32_t side      = 1u << bits;
+		const uint32_t step      = 256 >> bits;
+		const size_t   cellCount = size_t(1) << (3 * bits);
+
+		// Per cell: p0 = entry nearest to the cell's center c, r = how far any color in the cell can be from c. By the triangle
+		// inequality, nothing further than d(c, p0) + 2r from the center can beat p0 for a color in the cell. OKLab isn't linear in RGB,
+		// so r is measured to the cell's corners and padded.
+		const float radiusPadding = m_options.metric == PaletteMetric::OKLab ? 1.25f : 1.0f;
+
+		// neighbouring cells share corners, so convert each lattice point once
+		const uint32_t     latticeSide = side + 1;
+		std::vector<Point> lattice(size_t(latticeSide) * latticeSide * latticeSide);
+		auto               latticeChannel = [step](uint32_t i) { return static_cast<uint8_t>(std::min<uint32_t>(i * step, 255)); };
+		Helper::parallelFor(lattice.size(), 4096, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				const uint32_t r = static_cast<uint32_t>(i / (size_t(latticeSide) * latticeSide));
+				const uint32_t g = static_cast<uint32_t>((i / latticeSide) % latticeSide);
+				const uint32_t b = static_cast<uint32_t>(i % latticeSide);
+				lattice[i]       = ToPoint(Color(latticeChannel(r), latticeChannel(g), latticeChannel(b), uint8_t{255}));
+			}
+		});
 
-	std::string fcolorToHexRGBA(const FColor &col) {
-		std::stringstream ss;
-		ss << "0x" << std::uppercase << std::setfill('0') << std::hex << std::setw(2) << static_cast<int>(col.R) << std::setw(2)
-		   << static_cast<int>(col.G) << std::setw(2) << static_cast<int>(col.B) << std::setw(2) << static_cast<int>(col.A);
-		return ss.str();
+		std::mutex                              chunksMutex;
+		std::map<size_t, std::vector<uint16_t>> chunkCandidates;
+		std::vector<uint32_t>                   cellCounts(cellCount, 0);
+
+		Helper::parallelFor(cellCount, 1024, [&](size_t begin, size_t end) {
+			std::vector<uint16_t> candidates;
+			for (size_t cell = begin; cell < end; ++cell) {
+				const uint32_t r = static_cast<uint32_t>(cell >> (2 * bits));
+				const uint32_t g = static_cast<uint32_t>((cell >> bits) & (side - 1));
+				const uint32_t b = static_cast<uint32_t>(cell & (side - 1));
+
+				auto        middle = [step](uint32_t i) { return static_cast<uint8_t>(i * step + step / 2); };
+				const Point center = ToPoint(Color(middle(r), middle(g), middle(b), uint8_t{255}));
+				float radius = 0.0f;
+				for (uint32_t corner = 0; corner < 8; ++corner) {
+					const size_t index = (size_t(r + (corner >> 2)) * latticeSide + (g + ((corner >> 1) & 1))) * latticeSide + (b + (corner & 1));
+					radius             = std::max(radius, distanceSquared(center, lattice[index]));
+				}
+				radius = std::sqrt(radius) * radiusPadding + 1e-4f;
+
+				const uint32_t nearest = NearestOf(center, nullptr, m_points.size());
+				const size_t   first   = candidates.size();
+				if (nearest != npos) {
+					const float limit = std::sqrt(distanceSquared(center, m_points[nearest])) + 2.0f * radius;
+					for (size_t index = 0; index < m_points.size(); ++index) {
+						if (distanceSquared(center, m_points[index]) <= limit * limit)
+							candidates.push_back(static_cast<uint16_t>(index));
+					}
+				}
+				cellCounts[cell] = static_cast<uint32_t>(candidates.size() - first);
+			}
+
+			std::lock_guard lock(chunksMutex);
+			chunkCandidates.emplace(begin, std::move(candidates));
+		});
+
+		// chunks are keyed by their first cell, so walking the map keeps the candidates in cell order
+		m_candidates.clear();
+		for (auto &[begin, candidates] : chunkCandidates)
+			m_candidates.insert(m_candidates.end(), candidates.begin(), candidates.end());
+
+		m_cellOffsets.assign(cellCount + 1, 0);
+		for (size_t cell = 0; cell < cellCount; ++cell)
+			m_cellOffsets[cell + 1] = m_cellOffsets[cell] + cellCounts[cell];
 	}
 
-	FColor hexRGBAtoFColor(const std::string &hex) {
-		if (hex.size() != 10 || hex.substr(0, 2) != "0x")
-			throw std::invalid_argument("Invalid color hex string format. Expected format: 0xRRGGBBAA");
+	uint32_t PaletteMatcher::Nearest(const Color &color) const {
+		if (m_palette.empty())
+			return npos;
+
+		const uint32_t bits  = m_options.gridBits;
+		const uint32_t shift = 8 - bits;
+		const size_t   cell  = (size_t(color.R >> shift) << (2 * bits)) | (size_t(color.G >> shift) << bits) | size_t(color.B >> shift);
+		const uint32_t begin = m_cellOffsets[cell];
+		const uint32_t count = m_cellOffsets[cell + 1] - begin;
 
-		// Convert hex string (skip '0x')
-		uint32_t value = std::stoul(hex.substr(2), nullptr, 16);
+		if (count == 1)
+			return m_candidates[begin];
+		return NearestOf(ToPoint(color), m_candidates.data() + begin, count);
+	}
 
-		FColor col;
-		col.R = (value >> 24) & 0xFF;
-		col.G = (value >> 16) & 0xFF;
-		col.B = (value >> 8) & 0xFF;
-		col.A = value & 0xFF;
+	uint32_t PaletteMatcher::NearestBruteForce(const Color &color) const { return NearestOf(ToPoint(color), nullptr, m_points.size()); }
 
-		return col;
+	void PaletteMatcher::NearestBatch(const Color *src, uint32_t *dst, size_t count) const {
+		for (size_t i = 0; i < count; ++i)
+			dst[i] = Nearest(src[i]);
 	}
 } // namespace Colors
 
 // Color class
-Color::Color() : R(255), G(255), B(255), A(255) {}
-Color::Color(uint8_t rgba) : R(rgba), G(rgba), B(rgba), A(rgba) {}
-Color::Color(int32_t rgba) : R(rgba), G(rgba), B(rgba), A(rgba) {}
-Color::Color(uint8_t r, uint8_t g, uint8_t b, uint8_t a) : R(r), G(g), B(b), A(a) {}
-Color::Color(int32_t r, int32_t g, int32_t b, int32_t a) : R(r), G(g), B(b), A(a) {}
 Color::Color(float r, float g, float b, float a) : R(255), G(255), B(255), A(255) { FromLinear(CoolerLinearColor(r, g, b, a)); }
 Color::Color(const std::string &hexColor) : R(255), G(255), B(255), A(255) { FromHex(hexColor); }
-Color::Color(const struct FColor &color) : R(color.R), G(color.G), B(color.B), A(color.A) {}
-Color::Color(const Color &color) : R(color.R), G(color.G), B(color.B), A(color.A) {}
 Color::Color(float arr[3]) : R(255), G(255), B(255), A(255) { FromLinear(CoolerLinearColor(arr[0], arr[1], arr[2], 1.0f)); }
-Color::~Color() {}
 
 struct FColor Color::UnrealColor() const {
 	return FColor{B, G, R, A}; // Your game might be in a different format (RGBA), so be aware of that.
@@ -1118,13 +4788,6 @@ struct FColor Color::UnrealColor() const {
 
 class CoolerLinearColor Color::ToLinear() const { return CoolerLinearColor().FromColor(*this); }
 
-uint32_t Color::ToDecimal() const {
-	return Format::ToDecimal(
-	    ToHex(false)); // Standard method would be "uint32_t decimalValue = (R & 0xFF) << 16) | ((G & 0xFF) << 8) | (B & 0xFF);"
-}
-
-uint32_t Color::ToDecimalAlpha() const { return Format::ToDecimal(ToHexAlpha(false)); }
-
 std::string Color::ToHex(bool bNotation) const {
 	std::string hexStr = (bNotation ? "#" : "");
 	hexStr += Format::ToHex(static_cast<uint64_t>(R), 2, false);
@@ -1147,39 +4810,28 @@ Color &Color::FromLinear(const CoolerLinearColor &linearColor) {
 	return *this;
 }
 
-Color &Color::FromDecimal(uint32_t decimalColor) {
-	return FromHex(Format::ToHex(decimalColor, ((decimalColor > 0xFFFFFF) ? 8 : 6), false));
-}
-
-Color &Color::FromHex(std::string hexColor) {
-	Format::RemoveAllCharsInline(hexColor, '#');
-
-	if (Format::IsStringHexadecimal(hexColor)) {
-		if (hexColor.length() > 8) {
-			hexColor = hexColor.substr(0, 8);
-		}
-
-		uint32_t alpha = 255;
-
-		if (hexColor.length() == 8) {
-			alpha = Format::ToDecimal(hexColor.substr(6, 2)); // Optional, if an alpha value is provided.
-		}
-
-		A = static_cast<uint8_t>(alpha);
-
-		if (hexColor.length() > 6) {
-			hexColor = hexColor.substr(0, 6); // Removes the alpha value, or invalid trailing characters.
-		}
-
-		if (hexColor.length() == 6) {
-			uint32_t red   = Format::ToDecimal(hexColor.substr(0, 2));
-			uint32_t green = Format::ToDecimal(hexColor.substr(2, 2));
-			uint32_t blue  = Format::ToDecimal(hexColor.substr(4, 2));
-			R              = static_cast<uint8_t>(red);
-			G              = static_cast<uint8_t>(green);
-			B              = static_cast<uint8_t>(blue);
-		}
+Color &Color::FromHex(std::string_view hexColor) {
+	// legacy normalization: every '#' is dropped, wherever it is ("FF#8800" is FF8800). The rest has to be hex, but only the first
+	// 8 digits are used. Colors::parseHex is the strict version
+	char   digits[8];
+	size_t count = 0;
+	for (char c : hexColor) {
+		if (c == '#')
+			continue;
+		if (!std::isxdigit(static_cast<unsigned char>(c)))
+			return *this;
+		if (count < sizeof(digits))
+			digits[count] = c;
+		++count;
 	}
+	if (count == 0)
+		return *this;
+
+	A = 255;
+	if (count >= 8)
+		*this = *Colors::parseHex({digits, 8}, Colors::HexFormat::RGBA);
+	else if (count >= 6)
+		*this = *Colors::parseHex({digits, 6}, Colors::HexFormat::RGB);
 
 	return *this;
 }
@@ -1214,48 +4866,14 @@ Color &Color::Cycle(int32_t steps) {
 	return *this;
 }
 
-Color &Color::operator=(const Color &other) {
-	R = other.R;
-	G = other.G;
-	B = other.B;
-	A = other.A;
-	return *this;
-}
-
-Color &Color::operator=(const struct FColor &other) {
-	R = other.R;
-	G = other.G;
-	B = other.B;
-	A = other.A;
-	return *this;
-}
-
-bool Color::operator==(const Color &other) const { return (R == other.R && G == other.G && B == other.B && A == other.A); }
-bool Color::operator==(const struct FColor &other) const { return (R == other.R && G == other.G && B == other.B && A == other.A); }
-bool Color::operator!=(const Color &other) const { return !(*this == other); }
-bool Color::operator!=(const struct FColor &other) const { return !(*this == other); }
-bool Color::operator<(const Color &other) const { return (ToHexAlpha(false) < other.ToHexAlpha(false)); }
-bool Color::operator>(const Color &other) const { return (ToHexAlpha(false) > other.ToHexAlpha(false)); }
-
 // CoolerLinearColor class
-CoolerLinearColor::CoolerLinearColor() : R(1.0f), G(1.0f), B(1.0f), A(1.0f) {}
-CoolerLinearColor::CoolerLinearColor(float rgba) : R(rgba), G(rgba), B(rgba), A(rgba) {}
-CoolerLinearColor::CoolerLinearColor(float r, float g, float b, float a) : R(r), G(g), B(b), A(a) {}
 CoolerLinearColor::CoolerLinearColor(uint8_t r, uint8_t g, uint8_t b, uint8_t a) : R(1.0f), G(1.0f), B(1.0f), A(1.0f) {
 	FromColor(Color(a, g, b, a));
 }
 
 CoolerLinearColor::CoolerLinearColor(const std::string &hexColor) : R(1.0f), G(1.0f), B(1.0f), A(1.0f) { FromHex(hexColor); }
-CoolerLinearColor::CoolerLinearColor(const struct FLinearColor &linearColor)
-    : R(linearColor.R), G(linearColor.G), B(linearColor.B), A(linearColor.A) {}
-CoolerLinearColor::CoolerLinearColor(const CoolerLinearColor &linearColor)
-    : R(linearColor.R), G(linearColor.G), B(linearColor.B), A(linearColor.A) {}
-CoolerLinearColor::~CoolerLinearColor() {}
 
 struct FLinearColor CoolerLinearColor::UnrealColor() const { return FLinearColor{R, G, B, A}; }
-Color               CoolerLinearColor::ToColor() const { return Color(R, G, B, A); }
-uint32_t            CoolerLinearColor::ToDecimal() const { return ToColor().ToDecimal(); }
-uint32_t            CoolerLinearColor::ToDecimalAlpha() const { return ToColor().ToDecimalAlpha(); }
 std::string         CoolerLinearColor::ToHex(bool bNotation) const { return ToColor().ToHex(bNotation); }
 std::string         CoolerLinearColor::ToHexAlpha(bool bNotation) const { return ToColor().ToHexAlpha(bNotation); }
 
@@ -1268,75 +4886,342 @@ CoolerLinearColor &CoolerLinearColor::FromColor(const Color &color) {
 }
 
 CoolerLinearColor &CoolerLinearColor::FromDecimal(uint32_t decimalColor) { return FromColor(Color().FromDecimal(decimalColor)); }
-CoolerLinearColor &CoolerLinearColor::FromHex(std::string hexColor) { return FromColor(Color(hexColor)); }
+CoolerLinearColor &CoolerLinearColor::FromHex(std::string_view hexColor) { return FromColor(Color().FromHex(hexColor)); }
 CoolerLinearColor &CoolerLinearColor::Cycle(int32_t steps) { return FromColor(ToColor().Cycle(steps)); }
 
-CoolerLinearColor &CoolerLinearColor::operator=(const CoolerLinearColor &other) {
-	R = other.R;
-	G = other.G;
-	B = other.B;
-	A = other.A;
-	return *this;
+// GRainbowColor class
+Color             GRainbowColor::GetByte() { return RainbowGenerator::hueAt(position.load(std::memory_order_relaxed)); }
+CoolerLinearColor GRainbowColor::GetLinear() { return GetByte().ToLinear(); }
+FLinearColor      GRainbowColor::GetFLinear() { return GetLinear().UnrealColor(); }
+int32_t           GRainbowColor::GetDecimal() { return static_cast<int32_t>(GetByte().ToDecimal()); }
+
+void GRainbowColor::Reset() { position.store(0, std::memory_order_relaxed); }
+void GRainbowColor::OnTick() { Advance(1); }
+
+void GRainbowColor::Advance(uint64_t steps) {
+	// keep the counter inside one cycle so it never wraps mid-cycle
+	uint64_t current = position.load(std::memory_order_relaxed);
+	while (!position.compare_exchange_weak(current, (current + steps) % RainbowGenerator::hueSteps, std::memory_order_relaxed)) {}
 }
 
-CoolerLinearColor &CoolerLinearColor::operator=(const struct FLinearColor &other) {
-	R = other.R;
-	G = other.G;
-	B = other.B;
-	A = other.A;
-	return *this;
+void GRainbowColor::IncrementTick() {
+	uint32_t current = tickCounter.load(std::memory_order_relaxed);
+	while (!tickCounter.compare_exchange_weak(current, current + 1 == UINT32_MAX ? 0 : current + 1, std::memory_order_relaxed)) {}
 }
 
-bool CoolerLinearColor::operator==(const CoolerLinearColor &other) const {
-	return (R == other.R && G == other.G && B == other.B && A == other.A);
+bool GRainbowColor::TickCountIsMultipleOf(int num) { return tickCounter.load(std::memory_order_relaxed) % num == 0; }
+
+void GRainbowColor::TickRGB(int speed, int defaultSpeed) {
+	IncrementTick();
+
+	// if less than default speed
+	if (speed < defaultSpeed) {
+		if (TickCountIsMultipleOf(defaultSpeed - speed))
+			OnTick();
+	}
+	// if greater than (or equal to) default speed, take all the steps at once instead of cycling one at a time
+	else {
+		Advance(static_cast<uint64_t>(speed - defaultSpeed) + 1);
+	}
 }
 
-bool CoolerLinearColor::operator==(const struct FLinearColor &other) const {
-	return (R == other.R && G == other.G && B == other.B && A == other.A);
+// RainbowGenerator class
+namespace {
+	// hueLUT[i] == Color(0, 0, 255, 255).Cycle() applied i times
+	constexpr std::array<Color, RainbowGenerator::hueSteps> hueLUT = [] {
+		std::array<Color, RainbowGenerator::hueSteps> lut{};
+		for (uint32_t i = 0; i < RainbowGenerator::hueSteps; ++i) {
+			const int32_t up   = static_cast<int32_t>(i % 255);
+			const int32_t down = 255 - up;
+			switch (i / 255) {
+			case 0: lut[i] = Color(up, 0, 255, 255); break;   // red goes up
+			case 1: lut[i] = Color(255, 0, down, 255); break; // blue goes down
+			case 2: lut[i] = Color(255, up, 0, 255); break;   // green goes up
+			case 3: lut[i] = Color(down, 255, 0, 255); break; // red goes down
+			case 4: lut[i] = Color(0, 255, up, 255); break;   // blue goes up
+			default: lut[i] = Color(0, down, 255, 255); break; // green goes down
+			}
+		}
+		return lut;
+	}();
+} // namespace
+
+Color RainbowGenerator::hueAt(uint64_t step) { return hueLUT[step % hueSteps]; }
+
+Color RainbowGenerator::hueAt(double cycles) {
+	double fraction = cycles - std::floor(cycles);
+	if (!std::isfinite(fraction))
+		fraction = 0.0;
+	return hueLUT[std::min(static_cast<uint32_t>(fraction * hueSteps), hueSteps - 1)];
 }
 
-bool CoolerLinearColor::operator!=(const CoolerLinearColor &other) const { return !(*this == other); }
-bool CoolerLinearColor::operator!=(const struct FLinearColor &other) const { return !(*this == other); }
-bool CoolerLinearColor::operator<(const CoolerLinearColor &other) const { return (ToHexAlpha(false) < other.ToHexAlpha(false)); }
-bool CoolerLinearColor::operator>(const CoolerLinearColor &other) const { return (ToHexAlpha(false) > other.ToHexAlpha(false)); }
+Color RainbowGenerator::Evaluate(double cyclesPerSecond, double phase, double elapsedSeconds) {
+	return hueAt(phase + cyclesPerSecond * elapsedSeconds);
+}
 
-// GRainbowColor class
-Color             GRainbowColor::GetByte() { return ByteRainbow; }
-CoolerLinearColor GRainbowColor::GetLinear() { return LinearRainbow; }
-FLinearColor      GRainbowColor::GetFLinear() { return {LinearRainbow.R, LinearRainbow.G, LinearRainbow.B, LinearRainbow.A}; }
-int32_t           GRainbowColor::GetDecimal() { return (GetByte().R << 16) + (GetByte().G << 8) + GetByte().B; }
-
-void GRainbowColor::Reset() {
-	ByteRainbow   = Color(0, 0, 255, 255);
-	LinearRainbow = CoolerLinearColor(0.0f, 0.0f, 1.0f, 1.0f);
+double RainbowGenerator::CyclesPerSecondFromTickSpeed(int speed, int defaultSpeed, double ticksPerSecond) {
+	const double stepsPerTick = speed < defaultSpeed ? 1.0 / (defaultSpeed - speed) : static_cast<double>(speed - defaultSpeed + 1);
+	return stepsPerTick * ticksPerSecond / hueSteps;
 }
 
-void GRainbowColor::OnTick() {
-	ByteRainbow.Cycle();
-	LinearRainbow = ByteRainbow.ToLinear();
+std::optional<RainbowGenerator::ChannelId> RainbowGenerator::AddChannel(double cyclesPerSecond, double phase) {
+	const uint32_t id = m_channelCount.load(std::memory_order_relaxed);
+	if (id >= maxChannels) {
+		LOGERROR("RainbowGenerator is full ({} channels)", maxChannels);
+		return std::nullopt;
+	}
+
+	Channel &channel = m_channels[id];
+	channel.cyclesPerSecond.store(cyclesPerSecond, std::memory_order_relaxed);
+	channel.phase.store(phase, std::memory_order_relaxed);
+	channel.color.store(Evaluate(cyclesPerSecond, phase, Elapsed()), std::memory_order_relaxed);
+	m_channelCount.store(id + 1, std::memory_order_release); // publish after the channel is initialized
+	return id;
 }
 
-void GRainbowColor::IncrementTick() {
-	tickCounter++;
+void RainbowGenerator::SetSpeed(ChannelId id, double cyclesPerSecond) {
+	if (id < ChannelCount())
+		m_channels[id].cyclesPerSecond.store(cyclesPerSecond, std::memory_order_relaxed);
+}
 
-	if (tickCounter == UINT32_MAX)
-		tickCounter = 0;
+void RainbowGenerator::SetPhase(ChannelId id, double phase) {
+	if (id < ChannelCount())
+		m_channels[id].phase.store(phase, std::memory_order_relaxed);
 }
 
-bool GRainbowColor::TickCountIsMultipleOf(int num) { return tickCounter % num == 0; }
+void RainbowGenerator::Update(double elapsedSeconds) {
+	m_elapsed.store(elapsedSeconds, std::memory_order_relaxed);
 
-void GRainbowColor::TickRGB(int speed, int defaultSpeed) {
-	IncrementTick();
+	const size_t count = ChannelCount();
+	for (size_t i = 0; i < count; ++i) {
+		Channel    &channel = m_channels[i];
+		const Color color =
+		    Evaluate(channel.cyclesPerSecond.load(std::memory_order_relaxed), channel.phase.load(std::memory_order_relaxed), elapsedSeconds);
+		channel.color.store(color, std::memory_order_relaxed);
+	}
+}
 
-	// if less than default speed
-	if (speed < defaultSpeed) {
-		if (TickCountIsMultipleOf(defaultSpeed - speed))
-			OnTick();
+Color RainbowGenerator::Snapshot(ChannelId id) const {
+	if (id >= ChannelCount())
+		return Color();
+	return m_channels[id].color.load(std::memory_order_relaxed);
+}
+
+CoolerLinearColor RainbowGenerator::SnapshotLinear(ChannelId id) const { return Snapshot(id).ToLinear(); }
+FLinearColor      RainbowGenerator::SnapshotFLinear(ChannelId id) const { return SnapshotLinear(id).UnrealColor(); }
+
+namespace Animation {
+	float applyEase(Ease ease, float t) {
+		constexpr float pi = 3.14159265358979f;
+
+		switch (ease) {
+		case Ease::Linear: return t;
+		case Ease::InQuad: return t * t;
+		case Ease::OutQuad: return 1.0f - (1.0f - t) * (1.0f - t);
+		case Ease::InOutQuad: return t < 0.5f ? 2.0f * t * t : 1.0f - 2.0f * (1.0f - t) * (1.0f - t);
+		case Ease::InCubic: return t * t * t;
+		case Ease::OutCubic: return 1.0f - (1.0f - t) * (1.0f - t) * (1.0f - t);
+		case Ease::InOutCubic: return t < 0.5f ? 4.0f * t * t * t : 1.0f - 4.0f * (1.0f - t) * (1.0f - t) * (1.0f - t);
+		case Ease::InOutSine: return 0.5f - 0.5f * std::cos(pi * t);
+		case Ease::Step: return t >= 1.0f ? 1.0f : 0.0f;
+		default: return t;
+		}
 	}
-	// if greater than (or equal to) default speed
-	else if (speed >= defaultSpeed) {
-		for (int i = 0; i < (speed - defaultSpeed + 1); ++i)
-			OnTick();
+
+	TweenHandle Tweener::Add(const float *from, const float *to, size_t lanes, float duration, Ease ease, Loop loop) {
+		uint32_t slot;
+		if (!m_freeSlots.empty()) {
+			slot = m_freeSlots.back();
+			m_freeSlots.pop_back();
+		} else {
+			slot = static_cast<uint32_t>(m_slots.size());
+			m_slots.emplace_back();
+		}
+
+		const uint32_t dense = static_cast<uint32_t>(m_elapsed.size());
+		m_slots[slot].dense  = dense;
+
+		// unused lanes stay 0 --> 0, so the update loop doesn't need to know how many lanes a track has
+		for (size_t lane = 0; lane < 4; ++lane) {
+			m_from[lane].push_back(lane < lanes ? from[lane] : 0.0f);
+			m_to[lane].push_back(lane < lanes ? to[lane] : 0.0f);
+			m_value[lane].push_back(m_from[lane].back());
+		}
+		m_elapsed.push_back(0.0f);
+		m_duration.push_back(std::max(duration, 0.0f));
+		m_eased.push_back(0.0f);
+		m_ease.push_back(ease);
+		m_loop.push_back(loop);
+		m_denseToSlot.push_back(slot);
+
+		return {slot, m_slots[slot].generation};
 	}
-}
+
+	TweenHandle Tweener::Add(float from, float to, float duration, Ease ease, Loop loop) { return Add(&from, &to, 1, duration, ease, loop); }
+
+	TweenHandle Tweener::Add(const FVector &from, const FVector &to, float duration, Ease ease, Loop loop) {
+		const float fromLanes[3] = {from.X, from.Y, from.Z};
+		const float toLanes[3]   = {to.X, to.Y, to.Z};
+		return Add(fromLanes, toLanes, 3, duration, ease, loop);
+	}
+
+	TweenHandle Tweener::Add(const CoolerLinearColor &from, const CoolerLinearColor &to, float duration, Ease ease, Loop loop) {
+		const float fromLanes[4] = {from.R, from.G, from.B, from.A};
+		const float toLanes[4]   = {to.R, to.G, to.B, to.A};
+		return Add(fromLanes, toLanes, 4, duration, ease, loop);
+	}
+
+	std::optional<size_t> Tweener::Resolve(TweenHandle handle) const {
+		if (handle.slot >= m_slots.size() || m_slots[handle.slot].generation != handle.generation)
+			return std::nullopt;
+		return m_slots[handle.slot].dense;
+	}
+
+	bool Tweener::Remove(TweenHandle handle) {
+		const std::optional<size_t> dense = Resolve(handle);
+		if (!dense)
+			return false;
+
+		// swap-remove keeps the track arrays contiguous, the moved track's slot is pointed at its new index
+		const size_t last = m_elapsed.size() - 1;
+		auto         pop  = [&](auto &values) {
+			values[*dense] = values[last];
+			values.pop_back();
+		};
+		for (size_t lane = 0; lane < 4; ++lane) {
+			pop(m_from[lane]);
+			pop(m_to[lane]);
+			pop(m_value[lane]);
+		}
+		pop(m_elapsed);
+		pop(m_duration);
+		pop(m_eased);
+		pop(m_ease);
+		pop(m_loop);
+		pop(m_denseToSlot);
+
+		if (*dense != last)
+			m_slots[m_denseToSlot[*dense]].dense = static_cast<uint32_t>(*dense);
+
+		m_slots[handle.slot].generation++;
+		m_freeSlots.push_back(handle.slot);
+		return true;
+	}
+
+	void Tweener::Clear() {
+		for (uint32_t slot : m_denseToSlot) {
+			m_slots[slot].generation++;
+			m_freeSlots.push_back(slot);
+		}
+
+		for (size_t lane = 0; lane < 4; ++lane) {
+			m_from[lane].clear();
+			m_to[lane].clear();
+			m_value[lane].clear();
+		}
+		m_elapsed.clear();
+		m_duration.clear();
+		m_eased.clear();
+		m_ease.clear();
+		m_loop.clear();
+		m_denseToSlot.clear();
+	}
+
+	void Tweener::Tick(float deltaSeconds) {
+		const size_t count = m_elapsed.size();
+
+		// progress + easing, one track at a time since every track can loop and ease differently
+		for (size_t i = 0; i < count; ++i) {
+			const float duration = m_duration[i];
+			float       elapsed  = m_elapsed[i] + deltaSeconds;
+			float       t        = 1.0f;
+
+			if (duration <= 0.0f) {
+				elapsed = 0.0f;
+			} else {
+				switch (m_loop[i]) {
+				case Loop::Once:
+					elapsed = std::min(elapsed, duration);
+					t       = elapsed / duration;
+					break;
+				case Loop::Repeat:
+					elapsed = std::fmod(elapsed, duration);
+					t       = elapsed / duration;
+					break;
+				case Loop::PingPong:
+					elapsed = std::fmod(elapsed, 2.0f * duration);
+					t       = elapsed <= duration ? elapsed / duration : 2.0f - elapsed / duration;
+					break;
+				}
+			}
+
+			m_elapsed[i] = elapsed;
+			m_eased[i]   = applyEase(m_ease[i], t);
+		}
+
+		// interpolation, plain loops over contiguous floats that the compiler vectorizes
+		const float *eased = m_eased.data();
+		for (size_t lane = 0; lane < 4; ++lane) {
+			const float *from  = m_from[lane].data();
+			const float *to    = m_to[lane].data();
+			float       *value = m_value[lane].data();
+			for (size_t i = 0; i < count; ++i)
+				value[i] = from[i] + (to[i] - from[i]) * eased[i];
+		}
+	}
+
+	void Tweener::Retarget(TweenHandle handle, const float *to, size_t lanes) {
+		const std::optional<size_t> dense = Resolve(handle);
+		if (!dense)
+			return;
+
+		for (size_t lane = 0; lane < 4; ++lane) {
+			m_from[lane][*dense] = m_value[lane][*dense];
+			m_to[lane][*dense]   = lane < lanes ? to[lane] : 0.0f;
+		}
+		m_elapsed[*dense] = 0.0f;
+	}
+
+	void Tweener::Retarget(TweenHandle handle, const FVector &to) {
+		const float lanes[3] = {to.X, to.Y, to.Z};
+		Retarget(handle, lanes, 3);
+	}
+
+	void Tweener::Retarget(TweenHandle handle, const CoolerLinearColor &to) {
+		const float lanes[4] = {to.R, to.G, to.B, to.A};
+		Retarget(handle, lanes, 4);
+	}
+
+	void Tweener::Restart(TweenHandle handle) {
+		if (const std::optional<size_t> dense = Resolve(handle)) {
+			m_elapsed[*dense] = 0.0f;
+			for (size_t lane = 0; lane < 4; ++lane)
+				m_value[lane][*dense] = m_from[lane][*dense];
+		}
+	}
+
+	bool Tweener::Finished(TweenHandle handle) const {
+		const std::optional<size_t> dense = Resolve(handle);
+		return !dense || (m_loop[*dense] == Loop::Once && m_elapsed[*dense] >= m_duration[*dense]);
+	}
+
+	float Tweener::GetFloat(TweenHandle handle) const {
+		const std::optional<size_t> dense = Resolve(handle);
+		return dense ? m_value[0][*dense] : 0.0f;
+	}
+
+	FVector Tweener::GetVector(TweenHandle handle) const {
+		const std::optional<size_t> dense = Resolve(handle);
+		if (!dense)
+			return FVector{0.0f, 0.0f, 0.0f};
+		return FVector{m_value[0][*dense], m_value[1][*dense], m_value[2][*dense]};
+	}
+
+	CoolerLinearColor Tweener::GetColor(TweenHandle handle) const {
+		const std::optional<size_t> dense = Resolve(handle);
+		if (!dense)
+			return CoolerLinearColor(0.0f, 0.0f, 0.0f, 0.0f);
+		return CoolerLinearColor(m_value[0][*dense], m_value[1][*dense], m_value[2][*dense], m_value[3][*dense]);
+	}
+} // namespace Animation
 #endif // NO_RLSDK
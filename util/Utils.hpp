@@ -2,32 +2,15 @@
 #include "pch.h"
 #include <unordered_set>
 #include <array>
-
-#ifdef NO_RLSDK
-namespace StringUtils {
-	inline std::string ToString(const std::wstring &str) {
-		if (str.empty())
-			return "";
-		int32_t size = WideCharToMultiByte(CP_UTF8, 0, str.data(), -1, nullptr, 0, nullptr, nullptr);
-		if (size <= 0)
-			return "";
-		std::string return_str(size - 1, 0);
-		WideCharToMultiByte(CP_UTF8, 0, str.data(), -1, return_str.data(), size, nullptr, nullptr);
-		return return_str;
-	}
-
-	inline std::wstring ToWideString(const std::string &str) {
-		if (str.empty())
-			return L"";
-		int32_t size = MultiByteToWideChar(CP_UTF8, 0, str.data(), -1, nullptr, 0);
-		if (size <= 0)
-			return L"";
-		std::wstring return_str(size - 1, 0);
-		MultiByteToWideChar(CP_UTF8, 0, str.data(), -1, return_str.data(), size);
-		return return_str;
-	}
-} // namespace StringUtils
-#endif
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory_resource>
+#include <set>
+#include <span>
+#include <thread>
+#include <tuple>
 
 namespace Memory {
 	struct PatternData {
@@ -52,6 +35,69 @@ namespace Memory {
 	uintptr_t findPattern(HMODULE module, const std::string &sig);
 	uintptr_t findPattern(HMODULE module, const unsigned char *pattern, const char *mask);
 	uintptr_t getRipRelativeAddr(uintptr_t startAddr, int offsetToDisplacementInt32);
+
+	/*
+	    Scratch memory for things that only need to live for one ImGui frame (lowercased copies, formatted labels, key lists...).
+	    Allocating is a pointer bump, freeing is a no-op, and Reset() hands the whole buffer back at once. It's a
+	    std::pmr::memory_resource, so pmr strings/containers can allocate from it directly.
+
+	    USAGE:
+	        auto &arena = GUI::frameArena(); // in render code. Resets itself on the first call of each ImGui frame
+
+	        std::pmr::string lower = Format::ToLower(name, &arena);
+	        ImGui::TextUnformatted(arena.Format("{} / {}", done, total));
+
+	        // anywhere else, mark the frame boundary yourself
+	        Memory::frameArena().Reset();
+
+	    Nothing allocated from the arena may be kept past the next Reset(). A frame that outgrows the buffer spills onto the heap, and
+	    the next Reset() grows the buffer to fit it, so steady-state frames never touch the global heap. Not thread-safe
+	*/
+	class FrameArena : public std::pmr::memory_resource {
+	public:
+		struct Stats {
+			size_t   used      = 0; // bytes handed out since the last Reset()
+			size_t   peak      = 0; // highest `used` reached by any frame
+			size_t   capacity  = 0; // size of the preallocated buffer
+			uint64_t frames    = 0; // number of Reset() calls
+			uint64_t overflows = 0; // frames that spilled past the buffer onto the heap
+		};
+
+		explicit FrameArena(size_t initialCapacity = 64 * 1024);
+
+		FrameArena(const FrameArena &)            = delete;
+		FrameArena &operator=(const FrameArena &) = delete;
+
+		void  Reset();
+		Stats GetStats() const { return m_stats; }
+		void  LogStats() const;
+
+		// null-terminated copies that live until the next Reset(), handy for ImGui calls that take a const char *
+		const char *CopyString(std::string_view str);
+
+		template <typename... Args>
+		const char *Format(std::format_string<Args...> fmt, Args &&...args) {
+			// format_string<Args...> only accepts arguments forwarded as Args (plain lvalues would need format_string<Args &...>).
+			// Neither call moves from them, so forwarding twice is safe
+			const size_t size = std::formatted_size(fmt, std::forward<Args>(args)...);
+			char        *out  = static_cast<char *>(allocate(size + 1, alignof(char)));
+			*std::format_to_n(out, size, fmt, std::forward<Args>(args)...).out = '\0';
+			return out;
+		}
+
+	private:
+		void *do_allocate(size_t bytes, size_t alignment) override;
+		void  do_deallocate(void *, size_t, size_t) override {}
+		bool  do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+		std::unique_ptr<std::byte[]>                       m_buffer;
+		std::optional<std::pmr::monotonic_buffer_resource> m_resource;
+		Stats                                              m_stats;
+		bool                                               m_overflowed = false; // current frame spilled onto the heap
+	};
+
+	// The calling thread's arena (one per thread, created on first use)
+	FrameArena &frameArena();
 } // namespace Memory
 
 namespace Format {
@@ -109,9 +155,52 @@ namespace Format {
 	    'Z',
 	    ' '};
 
+	// Prefer Format_ObfuscatedLabel (below), which does the encoding at compile time and never touches the heap
 	void construct_label(const std::vector<int> &codes, std::string &out_str);
 
+	// String literal that's XOR-encoded at compile time, so the plaintext never shows up in the binary's string table.
+	// Use decode() for a one-off copy on the stack, or the Format_ObfuscatedLabel macro to decode once into static storage
+	template <size_t N>
+	class ObfuscatedString {
+		std::array<char, N> m_encoded{};
+		uint64_t            m_seed = 0;
+
+		static constexpr char keyAt(uint64_t seed, size_t i) {
+			uint64_t x = seed + 0x9E3779B97F4A7C15ull * (i + 1);
+			x          = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+			x          = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+			return static_cast<char>(x >> 56);
+		}
+
+	public:
+		consteval ObfuscatedString(const char (&str)[N], uint64_t seed) : m_seed(seed) {
+			for (size_t i = 0; i < N; ++i)
+				m_encoded[i] = static_cast<char>(str[i] ^ keyAt(seed, i));
+		}
+
+		// returns a null-terminated copy. Reads go through volatile so the optimizer can't fold the plaintext back into the binary
+		std::array<char, N> decode() const {
+			const volatile char *encoded = m_encoded.data();
+			std::array<char, N>  out{};
+			for (size_t i = 0; i < N; ++i)
+				out[i] = static_cast<char>(encoded[i] ^ keyAt(m_seed, i));
+			return out;
+		}
+
+		static constexpr size_t size() { return N - 1; }
+	};
+
+// Decodes the label the first time it's reached and returns a std::string_view into static storage from then on
+// Usage: std::string_view cmd = Format_ObfuscatedLabel("some secret label");
+#define Format_ObfuscatedLabel(str)                                                                                                        \
+	([]() -> std::string_view {                                                                                                            \
+		static constexpr Format::ObfuscatedString encoded{str, (__LINE__ * 0x9E3779B97F4A7C15ull) ^ __COUNTER__};                          \
+		static const auto                         decoded = encoded.decode();                                                             \
+		return {decoded.data(), encoded.size()};                                                                                           \
+	}())
+
 	std::string ToASCIIString(std::string str);
+	void        ToASCIIStringInline(std::string &str);
 
 	std::string ToHexString(uintptr_t address);
 
@@ -159,6 +248,17 @@ namespace Format {
 	std::string toCamelCase(const std::string &str);
 	std::string ToLower(std::string str);
 	void        ToLowerInline(std::string &str);
+
+	// Arena-aware variants, for per-frame UI code that shouldn't touch the global heap (see Memory::FrameArena)
+	std::pmr::string ToLower(std::string_view str, std::pmr::memory_resource *mem);
+	void             ToLowerInline(std::pmr::string &str);
+
+	template <typename... Args>
+	std::pmr::string FormatIn(std::pmr::memory_resource *mem, std::format_string<Args...> fmt, Args &&...args) {
+		std::pmr::string out{mem};
+		std::format_to(std::back_inserter(out), fmt, std::forward<Args>(args)...);
+		return out;
+	}
 	std::string RemoveAllChars(std::string str, char character);
 	void        RemoveAllCharsInline(std::string &str, char character);
 
@@ -171,14 +271,314 @@ namespace Format {
 
 	std::string ColorToHex(float colorsArray[3], bool bNotation);
 	uint64_t    HexToDecimal(const std::string &hexStr);
+
+	// Portable UTF-8 <--> wide string transcoding (UTF-16 on Windows, UTF-32 where wchar_t is 4 bytes).
+	// Single pass with a vectorized ASCII fast path. Invalid sequences are replaced with U+FFFD, like WideCharToMultiByte does.
+	std::wstring ToWideString(std::string_view str);
+	std::string  ToUTF8String(std::wstring_view str);
 } // namespace Format
 
+#ifdef NO_RLSDK
+namespace StringUtils {
+	inline std::string  ToString(const std::wstring &str) { return Format::ToUTF8String(str); }
+	inline std::wstring ToWideString(const std::string &str) { return Format::ToWideString(str); }
+} // namespace StringUtils
+#endif
+
 namespace Math {
 #ifndef NO_RLSDK
 	float distanceSquared(const FVector &a, const FVector &b);
 #endif
 } // namespace Math
 
+// Fast non-cryptographic random strings/IDs. Each thread owns a xoshiro256** state that's seeded once, on first use
+namespace Random {
+	constexpr std::string_view alphanumeric = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+	constexpr std::string_view hexLower     = "0123456789abcdef";
+
+	uint64_t next();
+	uint32_t nextBelow(uint32_t bound); // uniform in [0, bound)
+
+	// Fill caller-owned buffers. fillStrings writes `count` IDs of `length` chars back to back (count * length chars total)
+	void fillString(char *out, size_t length, std::string_view alphabet = alphanumeric);
+	void fillStrings(char *out, size_t count, size_t length, std::string_view alphabet = alphanumeric);
+
+	std::string              genString(size_t length, std::string_view alphabet = alphanumeric);
+	std::vector<std::string> genStrings(size_t count, size_t length, std::string_view alphabet = alphanumeric);
+
+	// Hands out IDs that never repeat for the lifetime of the session. Thread-safe
+	class UniqueIdSession {
+		std::unordered_set<std::string> m_issued;
+		std::mutex                      m_mutex;
+		std::string                     m_alphabet;
+		size_t                          m_length   = 0;
+		size_t                          m_capacity = 0; // number of possible IDs, saturated at SIZE_MAX
+
+	public:
+		explicit UniqueIdSession(size_t length, std::string_view alphabet = alphanumeric); // duplicate alphabet chars are ignored
+
+		std::optional<std::string> next(); // nullopt once every possible ID has been issued
+		std::vector<std::string>   next(size_t count);
+
+		bool   release(const std::string &id); // allows the ID to be issued again
+		void   clear();
+		size_t size();
+	};
+} // namespace Random
+
+/*
+    Typed JSON binding: a struct's fields are described once at compile time, and JSON is parsed straight into the struct by a pull
+    parser, without building a json DOM first. Errors come back as codes with the offset they occurred at, nothing throws.
+
+    USAGE:
+        struct Item {
+            std::string                name;
+            int                        count = 0;
+            std::optional<std::string> color;
+            std::vector<int>           ids;
+        };
+
+        template <>
+        struct JsonBind::Schema<Item> {
+            static constexpr auto fields = std::tuple{
+                JsonBind::required("name", &Item::name), JsonBind::field("count", &Item::count), JsonBind::field("color", &Item::color),
+                JsonBind::field("ids", &Item::ids)};
+        };
+
+        Item item;
+        if (auto error = JsonBind::parse(text, item))
+            LOGERROR("{} at offset {}", JsonBind::describe(error.code), error.offset);
+
+    Supported members: bool, integers (range checked), floating point, std::string, std::optional, std::vector, string-keyed maps and
+    other types with a Schema. Keys without a field are skipped, later duplicates overwrite earlier ones.
+*/
+namespace JsonBind {
+	enum class Errc : uint8_t {
+		None,
+		UnexpectedEnd,
+		Syntax,
+		TypeMismatch,
+		OutOfRange,
+		MissingField,
+		TooDeep,
+		TrailingData,
+		Unreadable // the input couldn't be read at all
+	};
+
+	struct Error {
+		Errc   code   = Errc::None;
+		size_t offset = 0; // in the input, where the problem was found
+
+		explicit operator bool() const { return code != Errc::None; }
+	};
+
+	std::string_view describe(Errc code);
+
+	// Pull parser over a complete JSON text. Every read returns false once something went wrong, and the first error is kept
+	class Reader {
+		const char *m_begin;
+		const char *m_pos;
+		const char *m_end;
+		Error       m_error;
+		int         m_depth = 0;
+
+		bool Expect(char c);
+		bool ReadNumberText(std::string_view &text, bool &integral);
+		bool ReadStringInto(std::string_view &view, std::string &scratch); // view into the input unless there are escapes
+
+	public:
+		enum class Token : uint8_t {
+			Object,
+			Array,
+			String,
+			Number,
+			Bool,
+			Null,
+			End,
+			Invalid
+		};
+
+		static constexpr int maxDepth = 256;
+
+		explicit Reader(std::string_view text) : m_begin(text.data()), m_pos(text.data()), m_end(text.data() + text.size()) {}
+
+		Token        Peek(); // skips whitespace
+		bool         Fail(Errc code);
+		const Error &GetError() const { return m_error; }
+
+		bool ReadNull();
+		bool ReadBool(bool &value);
+		bool ReadInt(int64_t &value);
+		bool ReadUInt(uint64_t &value);
+		bool ReadDouble(double &value);
+		bool ReadString(std::string &value);
+
+		// `first` starts out true for each object/array. These return false at the closing bracket, or on error (see GetError()).
+		// key stays valid until the next read
+		bool BeginObject();
+		bool NextKey(bool &first, std::string_view &key, std::string &scratch);
+		bool BeginArray();
+		bool NextElement(bool &first);
+
+		bool Skip();   // the next value, whatever it is
+		bool Finish(); // nothing but whitespace may follow
+	};
+
+	template <typename Class, typename Member>
+	struct Field {
+		std::string_view name;
+		Member Class::*member;
+		bool           required;
+	};
+
+	template <typename Class, typename Member>
+	constexpr Field<Class, Member> field(std::string_view name, Member Class::*member) {
+		return {name, member, false};
+	}
+
+	template <typename Class, typename Member>
+	constexpr Field<Class, Member> required(std::string_view name, Member Class::*member) {
+		return {name, member, true};
+	}
+
+	// Specialize with `static constexpr auto fields = std::tuple{field(...), ...};` (at most 64)
+	template <typename T>
+	struct Schema;
+
+	template <typename T>
+	concept HasSchema = requires { Schema<T>::fields; };
+
+	namespace detail {
+		template <typename T>
+		struct IsOptional : std::false_type {};
+		template <typename T>
+		struct IsOptional<std::optional<T>> : std::true_type {};
+
+		template <typename T>
+		struct IsVector : std::false_type {};
+		template <typename T, typename Alloc>
+		struct IsVector<std::vector<T, Alloc>> : std::true_type {};
+
+		template <typename T>
+		concept StringMap = requires(T map, std::string key) {
+			typename T::mapped_type;
+			requires std::same_as<typename T::key_type, std::string>;
+			map[key];
+		};
+
+		template <typename T>
+		bool read(Reader &reader, T &out);
+
+		template <HasSchema T>
+		bool readObject(Reader &reader, T &out) {
+			constexpr auto  &fields = Schema<T>::fields;
+			constexpr size_t count  = std::tuple_size_v<std::remove_cvref_t<decltype(fields)>>;
+			static_assert(count <= 64, "JsonBind schemas are limited to 64 fields");
+
+			constexpr uint64_t requiredMask = []<size_t... I>(std::index_sequence<I...>) {
+				return ((std::get<I>(fields).required ? uint64_t(1) << I : 0) | ... | 0);
+			}(std::make_index_sequence<count>{});
+
+			if (!reader.BeginObject())
+				return false;
+
+			uint64_t         seen  = 0;
+			bool             first = true;
+			std::string_view key;
+			std::string      scratch;
+			while (reader.NextKey(first, key, scratch)) {
+				// the first field with a matching name reads the value
+				bool matched = false, ok = true;
+				[&]<size_t... I>(std::index_sequence<I...>) {
+					((!matched && std::get<I>(fields).name == key
+					         ? (matched = true, seen |= uint64_t(1) << I, ok = read(reader, out.*(std::get<I>(fields).member)))
+					         : false),
+					    ...);
+				}(std::make_index_sequence<count>{});
+
+				if (!(matched ? ok : reader.Skip()))
+					return false;
+			}
+
+			if (reader.GetError())
+				return false;
+			return (seen & requiredMask) == requiredMask || reader.Fail(Errc::MissingField);
+		}
+
+		template <typename T>
+		bool read(Reader &reader, T &out) {
+			if constexpr (std::is_same_v<T, bool>) {
+				return reader.ReadBool(out);
+			} else if constexpr (std::is_integral_v<T>) {
+				if constexpr (std::is_signed_v<T>) {
+					int64_t value = 0;
+					if (!reader.ReadInt(value))
+						return false;
+					if (value < std::numeric_limits<T>::min() || value > std::numeric_limits<T>::max())
+						return reader.Fail(Errc::OutOfRange);
+					out = static_cast<T>(value);
+				} else {
+					uint64_t value = 0;
+					if (!reader.ReadUInt(value))
+						return false;
+					if (value > std::numeric_limits<T>::max())
+						return reader.Fail(Errc::OutOfRange);
+					out = static_cast<T>(value);
+				}
+				return true;
+			} else if constexpr (std::is_floating_point_v<T>) {
+				double value = 0.0;
+				if (!reader.ReadDouble(value))
+					return false;
+				out = static_cast<T>(value);
+				return true;
+			} else if constexpr (std::is_same_v<T, std::string>) {
+				return reader.ReadString(out);
+			} else if constexpr (IsOptional<T>::value) {
+				if (reader.Peek() == Reader::Token::Null) {
+					out.reset();
+					return reader.ReadNull();
+				}
+				return read(reader, out.emplace());
+			} else if constexpr (IsVector<T>::value) {
+				if (!reader.BeginArray())
+					return false;
+				out.clear();
+				for (bool first = true; reader.NextElement(first);) {
+					if (!read(reader, out.emplace_back()))
+						return false;
+				}
+				return !reader.GetError();
+			} else if constexpr (HasSchema<T>) {
+				return readObject(reader, out);
+			} else if constexpr (StringMap<T>) {
+				if (!reader.BeginObject())
+					return false;
+				out.clear();
+				std::string_view key;
+				std::string      scratch;
+				for (bool first = true; reader.NextKey(first, key, scratch);) {
+					if (!read(reader, out[std::string(key)]))
+						return false;
+				}
+				return !reader.GetError();
+			} else {
+				static_assert(HasSchema<T>, "JsonBind can't read this type, give it a JsonBind::Schema");
+				return false;
+			}
+		}
+	} // namespace detail
+
+	// Parses a whole JSON text into out. On error, out may be partially filled
+	template <typename T>
+	Error parse(std::string_view text, T &out) {
+		Reader reader(text);
+		if (detail::read(reader, out))
+			reader.Finish();
+		return reader.GetError();
+	}
+} // namespace JsonBind
+
 namespace Helper {
 	class ScopedFlag {
 		bool &m_flag;
@@ -237,6 +637,21 @@ namespace Helper {
 #ifndef NO_JSON
 	std::optional<json> getJsonFromStr(const std::string &str);
 #endif
+
+	// Parses straight into T through its JsonBind::Schema, no json DOM in between
+	template <typename T>
+	std::optional<T> getFromJsonStr(std::string_view str) {
+		T value{};
+		if (const auto error = JsonBind::parse(str, value)) {
+			LOGERROR("Unable to parse JSON: {} at offset {}", JsonBind::describe(error.code), error.offset);
+			return std::nullopt;
+		}
+		return value;
+	}
+
+	// Splits [0, count) into contiguous chunks of at least minChunk items and runs fn(begin, end) on each, using up to numThreads
+	// threads (the caller included). numThreads = 0 means std::thread::hardware_concurrency(). Returns once every chunk is done
+	void parallelFor(size_t count, size_t minChunk, const std::function<void(size_t begin, size_t end)> &fn, size_t numThreads = 0);
 } // namespace Helper
 
 namespace Files {
@@ -247,46 +662,541 @@ namespace Files {
 
 	constexpr std::array<std::string_view, 4> acceptableFormats = {".png", ".jpg", ".jpeg", ".bmp"};
 
-	template <typename MapType>
-	void FindImages(const fs::path &directory, MapType &imageMap, bool useStemFilename = false) {
-		static const std::unordered_set<std::string_view> formatSet{acceptableFormats.begin(), acceptableFormats.end()};
+	// Recursively lists the images in a directory, in the order a recursive_directory_iterator walk would visit them.
+	// All acceptableFormats match case-insensitively, pngOnly matches the exact ".png" extension like FindPngImages always has.
+	// Each directory's listing is cached by its last write time, so a repeated scan of an unchanged tree only stats the directories,
+	// and directories that did change are listed in parallel (one tree level at a time). The cache holds the 4096 most recently listed
+	// directories, and drops a directory's listing once it no longer exists.
+	std::vector<fs::path> ScanImages(const fs::path &directory, bool pngOnly = false);
+	void                  ClearImageScanCache();
+
+	enum class ImageFormat : uint8_t {
+		Unknown,
+		Png,
+		Jpeg,
+		Bmp
+	};
 
-		for (const auto &entry : fs::recursive_directory_iterator(directory)) {
-			if (!entry.is_regular_file())
-				continue;
+	struct ImageMetadata {
+		ImageFormat format   = ImageFormat::Unknown;
+		uint32_t    width    = 0;
+		uint32_t    height   = 0;
+		uint8_t     channels = 0; // 1 gray, 2 gray + alpha, 3 color (palettes included), 4 color + alpha
+		uint8_t     bitDepth = 0; // bits per channel, or per palette index for paletted images
+	};
 
-			auto extensionLower = Format::ToLower(entry.path().extension().string());
-			if (formatSet.contains(extensionLower)) {
-				std::string filename = useStemFilename ? entry.path().stem().string() : entry.path().filename().string();
-				imageMap[filename]   = entry.path();
-			}
+	// Reads just enough of the file to fill in ImageMetadata (PNG IHDR, JPEG SOF, BMP headers), the format comes from the file's
+	// signature rather than its extension. std::nullopt for unreadable or unsupported files
+	std::optional<ImageMetadata> ProbeImage(const fs::path &file);
+	// Probes every file, spread across threads. Results line up with the input
+	std::vector<std::optional<ImageMetadata>> ProbeImages(const std::vector<fs::path> &files);
+
+	// Image metadata persisted in a small binary file, so sizes/formats are known without decoding anything. Entries are matched by
+	// file size and last write time, so only new or changed files get probed again.
+	//
+	// USAGE:
+	//     Files::ImageIndex index(dataFolder / "image_index.bin");
+	//     auto metadata = index.Update(Files::ScanImages(decalsFolder)); // probes what's new, in parallel
+	//     index.Save();
+	class ImageIndex {
+		struct Entry {
+			uint64_t      fileSize  = 0;
+			int64_t       writeTime = 0; // file_time_type ticks
+			ImageMetadata metadata;
+		};
+
+		fs::path                                          m_indexFile;
+		std::unordered_map<fs::path::string_type, Entry> m_entries;
+		bool                                              m_dirty = false;
+
+		bool Load();
+
+	public:
+		explicit ImageIndex(fs::path indexFile); // loads the index if the file exists
+
+		// Metadata for every file (nullopt where probing failed), probing only the ones that aren't indexed or changed since
+		std::vector<std::optional<ImageMetadata>> Update(const std::vector<fs::path> &files);
+		std::optional<ImageMetadata>              Find(const fs::path &file) const; // as indexed, without touching the file
+		size_t                                    RemoveMissing();                  // drops entries whose file no longer exists
+		size_t                                    Size() const { return m_entries.size(); }
+
+		bool Save(); // writes through write_file_atomic, no-op if nothing changed
+	};
+
+	template <typename MapType>
+	void FindImages(const fs::path &directory, MapType &imageMap, bool useStemFilename = false) {
+		for (auto &path : ScanImages(directory)) {
+			std::string filename = useStemFilename ? path.stem().string() : path.filename().string();
+			imageMap[filename]   = std::move(path);
 		}
 	}
 
 	template <typename MapType>
 	void FindPngImages(const fs::path &directory, MapType &imageMap) {
-		for (const auto &entry : fs::recursive_directory_iterator(directory)) {
-			if (entry.is_regular_file() && entry.path().extension() == ".png") {
-				std::string filename = entry.path().stem().string();
-				imageMap[filename]   = entry.path();
-			}
+		for (auto &path : ScanImages(directory, true)) {
+			std::string filename = path.stem().string();
+			imageMap[filename]   = std::move(path);
 		}
 	}
 
 	void FindPngImages(const fs::path &directory, std::unordered_map<std::string, fs::path> &imageMap);
 	void FindPngImages(const fs::path &directory, std::vector<ImageInfo> &image_info);
 	void FindPngImages(const fs::path &directory, std::map<std::string, ImageInfo> &image_info_map);
+	// Watches a directory tree for images being added, removed, renamed (a removal plus an addition) or rewritten, through inotify on
+	// Linux and ReadDirectoryChangesW on Windows. Events are collected on a worker thread and settled batchDelay after the first one
+	// of a batch, so a burst of file operations becomes one batch. The first batch lists every image already there as Added, in
+	// ScanImages order.
+	// The destructor stops the worker thread, which isn't safe during DLL unload, so reset it in onUnload
+	class DirectoryWatcher {
+	public:
+		struct Change {
+			enum class Kind : uint8_t {
+				Added,
+				Removed,
+				Modified
+			};
+
+			Kind     kind;
+			fs::path path;
+		};
+
+	private:
+		fs::path                  m_directory;
+		bool                      m_pngOnly;
+		std::chrono::milliseconds m_batchDelay;
+		std::set<fs::path>        m_known; // worker thread only, once it runs
+		std::mutex                m_mutex;
+		std::vector<Change>       m_ready;
+		std::atomic<bool>         m_hasChanges = false;
+		std::atomic<bool>         m_stop       = false;
+		bool                      m_watching   = false;
+#ifdef _WIN32
+		HANDLE m_directoryHandle = INVALID_HANDLE_VALUE;
+		HANDLE m_stopEvent       = nullptr;
+#else
+		int                               m_inotify = -1;
+		int                               m_stopFd  = -1;
+		std::unordered_map<int, fs::path> m_watches; // watch descriptor -> directory
+		void                              WatchTree(const fs::path &directory);
+		void                              UnwatchTree(const fs::path &directory);
+#endif
+		std::thread m_worker;
+
+		bool IsWatchedImage(const fs::path &file) const;
+		void Settle(const std::set<fs::path> &dirty, const std::set<fs::path> &written);
+		void Run();
+
+	public:
+		explicit DirectoryWatcher(
+		    fs::path directory, bool pngOnly = false, std::chrono::milliseconds batchDelay = std::chrono::milliseconds(100));
+		DirectoryWatcher(const DirectoryWatcher &)            = delete;
+		DirectoryWatcher &operator=(const DirectoryWatcher &) = delete;
+		~DirectoryWatcher();
+
+		bool                IsWatching() const { return m_watching; } // false if the OS watch couldn't be set up
+		std::vector<Change> Poll();                                    // changes settled since the last call, cheap when there are none
+	};
+
+	// Keeps an image map (same MapType and keys as FindImages, FindPngImages is pngOnly + useStemFilename) current through a
+	// DirectoryWatcher, so picking up new or deleted images doesn't take a rescan. Poll() from the thread that owns the map, e.g. once
+	// per tick: it applies the settled changes and passes them to the callbacks. When several images share a key, the map keeps the
+	// last one added, and falls back to another one when it's removed.
+	//
+	// USAGE:
+	//     Files::ImageMapWatcher<std::unordered_map<std::string, fs::path>> decals(decalsFolder, decalMap, true, true);
+	//     decals.OnChange([](const auto &changes) { /* reload textures */ });
+	//     ...
+	//     decals.Poll(); // each tick
+	template <typename MapType>
+	class ImageMapWatcher {
+		using Callback = std::function<void(const std::vector<DirectoryWatcher::Change> &)>;
+
+		DirectoryWatcher                               m_watcher;
+		MapType                                       &m_map;
+		bool                                           m_useStemFilename;
+		std::unordered_multimap<std::string, fs::path> m_paths; // every known image by key
+		std::vector<Callback>                          m_callbacks;
+
+		std::string KeyOf(const fs::path &path) const { return m_useStemFilename ? path.stem().string() : path.filename().string(); }
+
+		void Apply(const DirectoryWatcher::Change &change) {
+			std::string key = KeyOf(change.path);
+			if (change.kind == DirectoryWatcher::Change::Kind::Added) {
+				m_paths.emplace(key, change.path);
+				m_map[std::move(key)] = change.path;
+				return;
+			}
+			if (change.kind != DirectoryWatcher::Change::Kind::Removed)
+				return;
+
+			auto [first, last] = m_paths.equal_range(key);
+			for (auto it = first; it != last; ++it) {
+				if (it->second == change.path) {
+					m_paths.erase(it);
+					break;
+				}
+			}
+
+			auto mapped = m_map.find(key);
+			if (mapped == m_map.end() || mapped->second != change.path)
+				return;
+			if (auto other = m_paths.find(key); other != m_paths.end())
+				mapped->second = other->second;
+			else
+				m_map.erase(mapped);
+		}
+
+	public:
+		ImageMapWatcher(const fs::path &directory, MapType &imageMap, bool pngOnly = false, bool useStemFilename = false)
+		    : m_watcher(directory, pngOnly), m_map(imageMap), m_useStemFilename(useStemFilename) {
+			Poll(); // the initial listing
+		}
+
+		bool IsWatching() const { return m_watcher.IsWatching(); }
+		void OnChange(Callback callback) { m_callbacks.push_back(std::move(callback)); }
+
+		// applies what changed since the last call and fires the callbacks once with the whole batch, returns the number of changes
+		size_t Poll() {
+			const std::vector<DirectoryWatcher::Change> changes = m_watcher.Poll();
+			if (changes.empty())
+				return 0;
+
+			for (const auto &change : changes)
+				Apply(change);
+			for (const auto &callback : m_callbacks)
+				callback(changes);
+			return changes.size();
+		}
+	};
+
 	void OpenFolder(const fs::path &folderPath);
+	// Keeps only the lines starting with startString. Large files are filtered in parallel chunks straight from a mapping, and the
+	// result replaces the file atomically through a temp file next to it
 	void FilterLinesInFile(const fs::path &filePath, const std::string &startString);
 
+	// Read-only view of a whole file. Files of at least mapThreshold bytes are memory mapped (CreateFileMapping / mmap) so they're
+	// never copied, smaller ones are read into a buffer sized up front with a single read, which is cheaper than mapping them.
+	class MappedFile {
+		const char *m_data   = nullptr;
+		size_t      m_size   = 0;
+		bool        m_mapped = false;
+		std::string m_buffer; // small file fallback
+
+	public:
+		static constexpr size_t mapThreshold = 64 * 1024;
+
+		MappedFile() = default;
+		explicit MappedFile(const fs::path &file) { Open(file); }
+		MappedFile(const MappedFile &)            = delete;
+		MappedFile &operator=(const MappedFile &) = delete;
+		MappedFile(MappedFile &&other) noexcept;
+		MappedFile &operator=(MappedFile &&other) noexcept;
+		~MappedFile() { Close(); }
+
+		bool Open(const fs::path &file); // false if the file can't be opened or read, empty files open fine
+		void Close();
+
+		bool                       IsOpen() const { return m_data != nullptr; }
+		bool                       IsMapped() const { return m_mapped; }
+		size_t                     Size() const { return m_size; }
+		std::string_view           View() const { return {m_data, m_size}; }
+		std::span<const std::byte> Bytes() const { return {reinterpret_cast<const std::byte *>(m_data), m_size}; }
+	};
+
+	// Line offsets of a large text file (game and plugin logs), found with a SIMD newline scan over a MappedFile, so it can be searched
+	// without splitting it into one string per line. Lines follow std::getline: a trailing newline doesn't start another line, and a
+	// '\r' before the newline isn't part of the line.
+	// Refresh() picks up data appended since the last scan by scanning only the new tail, and indexes the file again from scratch if
+	// it shrank or its indexed tail changed. Views returned by Line()/Lines() are only valid until the next Open()/Refresh().
+	// Meant for files that only grow: a file truncated while it's mapped has to be Refresh()ed before it's read again
+	class LineIndex {
+		fs::path            m_file;
+		MappedFile          m_mapped;
+		std::vector<size_t> m_newlines; // offset of every '\n'
+		std::string         m_tail;     // last bytes indexed, to tell an append from a rewrite
+
+		void                Scan(size_t from);
+		size_t              LineBegin(size_t line) const;
+		size_t              LineEnd(size_t line) const; // excludes the newline
+		std::vector<size_t> MatchLines(size_t first, size_t last, std::string_view term, bool ignoreCase) const;
+
+	public:
+		static constexpr size_t tailCheckSize = 64;
+
+		LineIndex() = default;
+		explicit LineIndex(const fs::path &file) { Open(file); }
+
+		bool Open(const fs::path &file);
+		bool Refresh(); // true if the file changed since the last scan
+
+		bool             IsOpen() const { return m_mapped.IsOpen(); }
+		std::string_view Text() const { return m_mapped.View(); }
+		size_t           LineCount() const;
+		std::string_view Line(size_t line) const;
+
+		// Line numbers (0-based, ascending) of the lines containing term. ignoreCase compares like Format::iContains
+		std::vector<size_t> Search(std::string_view term, bool ignoreCase = false) const;
+		// Lines containing every term (matchAll) or at least one of them. No terms match nothing
+		std::vector<size_t> SearchTerms(const std::vector<std::string_view> &terms, bool ignoreCase = false, bool matchAll = true) const;
+		std::vector<std::string_view> Lines(const std::vector<size_t> &lineNumbers) const;
+	};
+
+	// Runs file operations on a small pool of worker threads, so a burst of loads (e.g. at plugin startup) overlaps instead of running
+	// one after another on the calling thread. Jobs start in submission order. A job cancelled before it starts never runs, and its
+	// future throws std::future_error (broken_promise) instead.
+	// Shutdown() cancels whatever hasn't started and joins the workers. That isn't safe during DLL unload, so plugins using Shared()
+	// call Shared().Shutdown() in onUnload
+	class IOQueue {
+		struct Job {
+			uint64_t              id;
+			std::function<void()> run;
+		};
+
+		std::deque<Job>          m_jobs;
+		std::mutex               m_mutex;
+		std::condition_variable  m_wake; // workers: new job or stop
+		std::condition_variable  m_idle; // WaitIdle(): nothing queued or running
+		std::vector<std::thread> m_workers;
+		uint64_t                 m_nextId  = 1;
+		size_t                   m_running = 0;
+		bool                     m_stop    = false;
+
+		void Run();
+
+	public:
+		template <typename T>
+		struct Request {
+			uint64_t       id = 0; // for Cancel(), 0 if the queue was already shut down
+			std::future<T> future;
+		};
+
+		explicit IOQueue(size_t numThreads = 4);
+		IOQueue(const IOQueue &)            = delete;
+		IOQueue &operator=(const IOQueue &) = delete;
+		~IOQueue() { Shutdown(); }
+
+		static IOQueue &Shared();
+
+		uint64_t              Post(std::function<void()> job);
+		std::vector<uint64_t> PostBatch(std::vector<std::function<void()>> jobs); // one lock and one wake-up for the whole batch
+
+		template <typename Fn>
+		Request<std::invoke_result_t<Fn &>> Submit(Fn fn) {
+			auto       task   = std::make_shared<std::packaged_task<std::invoke_result_t<Fn &>()>>(std::move(fn));
+			auto       future = task->get_future();
+			const auto id     = Post([task] { (*task)(); });
+			return {id, std::move(future)};
+		}
+
+		// runs onComplete(result) (or onComplete() for void jobs) on the worker once fn returns
+		template <typename Fn, typename Callback>
+		uint64_t Submit(Fn fn, Callback onComplete) {
+			auto job = std::make_shared<std::pair<Fn, Callback>>(std::move(fn), std::move(onComplete));
+			return Post([job] {
+				try {
+					if constexpr (std::is_void_v<std::invoke_result_t<Fn &>>) {
+						job->first();
+						job->second();
+					} else {
+						job->second(job->first());
+					}
+				} catch (const std::exception &e) {
+					LOGERROR("IOQueue job failed: {}", e.what());
+				} catch (...) {
+					LOGERROR("IOQueue job failed with an unknown exception");
+				}
+			});
+		}
+
+		template <typename Fn>
+		std::vector<Request<std::invoke_result_t<Fn &>>> SubmitBatch(std::vector<Fn> fns) {
+			std::vector<Request<std::invoke_result_t<Fn &>>> requests(fns.size());
+			std::vector<std::function<void()>>               jobs;
+			jobs.reserve(fns.size());
+			for (size_t i = 0; i < fns.size(); ++i) {
+				auto task          = std::make_shared<std::packaged_task<std::invoke_result_t<Fn &>()>>(std::move(fns[i]));
+				requests[i].future = task->get_future();
+				jobs.push_back([task] { (*task)(); });
+			}
+
+			const std::vector<uint64_t> ids = PostBatch(std::move(jobs));
+			for (size_t i = 0; i < ids.size(); ++i)
+				requests[i].id = ids[i];
+			return requests;
+		}
+
+		bool   Cancel(uint64_t id); // true if the job hadn't started yet
+		size_t CancelAll();
+		size_t Pending();           // queued and running
+		void   WaitIdle();          // until nothing is queued or running
+		void   Shutdown();
+	};
+
 	std::string get_text_content(const fs::path &file_path);
 
+	// Replaces file with contents atomically: written to a uniquely named sibling temp file, flushed to disk, then renamed over the
+	// original. A crash leaves either the old file or the new one, never half of each
+	bool write_file_atomic(const fs::path &file, std::string_view contents);
+
 #ifndef NO_JSON
 	json get_json(const fs::path &file_path);
-	bool write_json(const fs::path &file_path, const json &j);
+	bool write_json(const fs::path &file_path, const json &j, bool compact = false); // atomic, indented by 4 unless compact
+#endif
+
+	// Reads a file straight into T through its JsonBind::Schema, without building a json DOM. Errors are logged and returned
+	template <typename T>
+	JsonBind::Error get_json_as(const fs::path &file_path, T &out) {
+		MappedFile file(file_path);
+		if (!file.IsOpen()) {
+			LOG("[ERROR] Unable to open '{}'", file_path.filename().string());
+			return {JsonBind::Errc::Unreadable, 0};
+		}
+
+		const JsonBind::Error error = JsonBind::parse(file.View(), out);
+		if (error)
+			LOG("[ERROR] Unable to read '{}': {} at offset {}", file_path.filename().string(), JsonBind::describe(error.code), error.offset);
+		return error;
+	}
+
+	// Same as the blocking versions, run on an IOQueue. Failures are logged and give the same empty/false results
+	std::future<std::string> get_text_content_async(const fs::path &file_path, IOQueue &queue = IOQueue::Shared());
+#ifndef NO_JSON
+	std::future<json> get_json_async(const fs::path &file_path, IOQueue &queue = IOQueue::Shared());
+	std::future<bool> write_json_async(const fs::path &file_path, json j, bool compact = false, IOQueue &queue = IOQueue::Shared());
+#endif
+	// raw file contents, e.g. image data for a decoder (empty if unreadable)
+	std::future<std::vector<uint8_t>>         read_file_async(const fs::path &file, IOQueue &queue = IOQueue::Shared());
+	std::future<std::optional<ImageMetadata>> ProbeImageAsync(const fs::path &file, IOQueue &queue = IOQueue::Shared());
+
+	// Versioned binary alternative to JSON for large data files: fixed-layout records (a presence bitmap, then one 8-byte slot per
+	// field) plus a deduplicated string table, read in place from a MappedFile. Opening only validates the header and field list,
+	// values are decoded when they're asked for and strings are views into the mapping.
+	// Write() imports JSON: an array of objects, or an object of objects (whose keys are kept in KeyField()). A field's type is the
+	// one all of its values share, integers mixed with floats become Float and anything else (nested values, nulls, mixed types) is
+	// stored as JSON text, so ToJson() gives back what was written. Multi-byte values are stored little-endian, in native layout.
+	//
+	// USAGE:
+	//     Files::Snapshot::Write(dataFolder / "items.snap", Files::get_json(dataFolder / "items.json"));
+	//     Files::Snapshot items(dataFolder / "items.snap");
+	//     const auto nameField = items.FindField("name");
+	//     for (size_t i = 0; nameField && i < items.Size(); ++i)
+	//         LOG("{}", items[i].GetString(*nameField).value_or(""));
+	class Snapshot {
+	public:
+		enum class FieldType : uint8_t {
+			Bool,
+			Int,
+			Float,
+			String,
+			Json // JSON text in the string table
+		};
+
+		static constexpr uint16_t version = 1;
+
+		class Record {
+			const Snapshot *m_snapshot = nullptr;
+			const char     *m_data     = nullptr;
+
+			bool Slot(size_t field, FieldType type, uint64_t &bits) const;
+
+		public:
+			Record(const Snapshot *snapshot, const char *data) : m_snapshot(snapshot), m_data(data) {}
+
+			bool                            Has(size_t field) const;
+			std::optional<bool>             GetBool(size_t field) const;
+			std::optional<int64_t>          GetInt(size_t field) const;
+			std::optional<double>           GetFloat(size_t field) const;  // Int fields convert
+			std::optional<std::string_view> GetString(size_t field) const; // Json fields give their text
+#ifndef NO_JSON
+			json Get(size_t field) const; // any field, null if it's missing
+			json ToJson() const;          // without the key field
+#endif
+		};
+
+	private:
+		struct Field {
+			std::string_view name;
+			FieldType        type;
+			uint32_t         slotOffset;
+		};
+
+		MappedFile         m_mapped;
+		std::vector<Field> m_fields;
+		const char        *m_records     = nullptr;
+		std::string_view   m_strings;
+		size_t             m_recordCount = 0;
+		size_t             m_recordSize  = 0;
+		size_t             m_keyField    = SIZE_MAX;
+		bool               m_open        = false;
+
+	public:
+		Snapshot() = default;
+		explicit Snapshot(const fs::path &file) { Open(file); }
+
+		bool Open(const fs::path &file); // false (and logged) for missing, corrupt or newer-version files
+		bool IsOpen() const { return m_open; }
+
+		size_t                Size() const { return m_recordCount; }
+		size_t                FieldCount() const { return m_fields.size(); }
+		std::string_view      FieldName(size_t field) const { return m_fields.at(field).name; }
+		FieldType             GetFieldType(size_t field) const { return m_fields.at(field).type; }
+		std::optional<size_t> FindField(std::string_view name) const;
+		std::optional<size_t> KeyField() const { return m_keyField == SIZE_MAX ? std::nullopt : std::optional(m_keyField); }
+		Record                operator[](size_t index) const { return {this, m_records + index * m_recordSize}; }
+
+#ifndef NO_JSON
+		json        ToJson() const;
+		static bool Write(const fs::path &file, const json &data); // atomic, see above for what data can be
+#endif
+	};
+
+	// Background persistence for settings and other snapshots. Saves to the same path within coalesceDelay of the first one collapse
+	// into a single write of the latest snapshot, and the writes (JSON serialization included) run on a worker thread through
+	// write_file_atomic, off the game thread.
+	// Own one per plugin and Flush() it in onUnload. The destructor flushes too, but joining threads during DLL unload isn't safe.
+	class AsyncWriter {
+		struct PendingWrite {
+			std::string                           contents;
+#ifndef NO_JSON
+			std::optional<json>                   snapshot; // serialized on the worker
+			bool                                  compact = false;
+#endif
+			std::chrono::steady_clock::time_point due;
+		};
+
+		std::map<fs::path, PendingWrite> m_pending;
+		std::mutex                       m_mutex;
+		std::condition_variable          m_wake;    // worker: new work, flush or stop
+		std::condition_variable          m_drained; // Flush(): nothing pending or in flight
+		std::chrono::milliseconds        m_coalesceDelay;
+		size_t                           m_inFlight = 0;
+		size_t                           m_failed   = 0; // failed writes since the last Flush()
+		bool                             m_flushing = false;
+		bool                             m_stop     = false;
+		std::thread                      m_worker;
+
+		void Run();
+		void Enqueue(const fs::path &file, PendingWrite write);
+
+	public:
+		explicit AsyncWriter(std::chrono::milliseconds coalesceDelay = std::chrono::milliseconds(250));
+		AsyncWriter(const AsyncWriter &)            = delete;
+		AsyncWriter &operator=(const AsyncWriter &) = delete;
+		~AsyncWriter();
+
+		void Write(const fs::path &file, std::string contents);
+#ifndef NO_JSON
+		void WriteJson(const fs::path &file, json snapshot, bool compact = false);
 #endif
 
-	void appendLineIfNotExist(const fs::path &file, const std::string &line);
+		bool   Flush(); // writes everything pending right away and waits for it, false if any write since the last Flush() failed
+		size_t Pending();
+	};
+
+	// Appends line (with a single append-mode write) unless the file already has it. With cacheLines, hashes of the file's lines are
+	// kept in memory and reused for as long as the file's size and write time don't change, so repeated calls don't reread it.
+	// That costs about 40 bytes per distinct line, and only the 16 most recently used files keep their hashes (older ones are rescanned)
+	void appendLineIfNotExist(const fs::path &file, const std::string &line, bool cacheLines = false);
 } // namespace Files
 
 #if !defined(NO_JSON) && !defined(NO_BAKKESMOD)
@@ -315,6 +1225,18 @@ namespace PluginUpdates {
 		std::string makePluginLoadCmd() const { return std::format("plugin load {}", Format::ToLower(name)); }
 	};
 
+	// the parts of a GitHub "latest release" API response that are used
+	struct GitHubReleaseAsset {
+		std::string name;
+		std::string browser_download_url;
+	};
+
+	struct GitHubRelease {
+		std::string                     name;
+		std::string                     html_url;
+		std::vector<GitHubReleaseAsset> assets;
+	};
+
 	extern PluginUpdaterInfo pluginUpdaterInfo;
 	extern PluginUpdateInfo  updateInfo;
 	extern std::mutex        updateMutex;
@@ -327,7 +1249,24 @@ namespace PluginUpdates {
 	std::optional<PluginUpdateInfo> getUpdateInfo(const json &releaseJson, const std::string &assetName);
 	std::optional<std::string>      getAssetDownloadUrl(const json &releaseJson, const std::string &assetName);
 	std::optional<std::string>      getVersionStr(const json &releaseJson);
+
+	std::optional<PluginUpdateInfo> getUpdateInfo(const GitHubRelease &release, const std::string &assetName);
+	std::optional<std::string>      getAssetDownloadUrl(const GitHubRelease &release, const std::string &assetName);
+	std::optional<std::string>      getVersionStr(const GitHubRelease &release);
 } // namespace PluginUpdates
+
+template <>
+struct JsonBind::Schema<PluginUpdates::GitHubReleaseAsset> {
+	static constexpr auto fields = std::tuple{JsonBind::required("name", &PluginUpdates::GitHubReleaseAsset::name),
+	    JsonBind::required("browser_download_url", &PluginUpdates::GitHubReleaseAsset::browser_download_url)};
+};
+
+template <>
+struct JsonBind::Schema<PluginUpdates::GitHubRelease> {
+	static constexpr auto fields = std::tuple{JsonBind::required("name", &PluginUpdates::GitHubRelease::name),
+	    JsonBind::required("html_url", &PluginUpdates::GitHubRelease::html_url),
+	    JsonBind::required("assets", &PluginUpdates::GitHubRelease::assets)};
+};
 #endif
 
 namespace Process {
@@ -358,41 +1297,68 @@ public:
 	uint8_t R, G, B, A;
 
 public:
-	Color();
-	explicit Color(uint8_t rgba);
-	explicit Color(int32_t rgba);
-	explicit Color(uint8_t r, uint8_t g, uint8_t b, uint8_t a);
-	explicit Color(int32_t r, int32_t g, int32_t b, int32_t a);
+	constexpr Color() : R(255), G(255), B(255), A(255) {}
+	constexpr explicit Color(uint8_t rgba) : R(rgba), G(rgba), B(rgba), A(rgba) {}
+	constexpr explicit Color(int32_t rgba) : R(rgba), G(rgba), B(rgba), A(rgba) {}
+	constexpr explicit Color(uint8_t r, uint8_t g, uint8_t b, uint8_t a) : R(r), G(g), B(b), A(a) {}
+	constexpr explicit Color(int32_t r, int32_t g, int32_t b, int32_t a) : R(r), G(g), B(b), A(a) {}
 	explicit Color(float r, float g, float b, float a); // Auto converts linear color values to bytes.
 	explicit Color(float arr[3]);                       // added by mwah
 	Color(const std::string &hexColor);
-	Color(const struct FColor &color);
-	Color(const Color &color);
-	~Color();
+	constexpr Color(const struct FColor &color) : R(color.R), G(color.G), B(color.B), A(color.A) {}
+	constexpr Color(const Color &color) = default;
+	constexpr ~Color()                  = default;
 
 public:
 	struct FColor           UnrealColor() const;
 	class CoolerLinearColor ToLinear() const;
-	uint32_t                ToDecimal() const;
-	uint32_t
-	ToDecimalAlpha() const; // Same as "ToDecimal" but includes the alpha channel, supported here but may not be standard elsewhere.
+
+	// Packed 0xRRGGBB / 0xRRGGBBAA, i.e. the digits ToHex/ToHexAlpha spell out. Ordering and hashing use these, no strings involved
+	constexpr uint32_t ToDecimal() const {
+		return (static_cast<uint32_t>(R) << 16) | (static_cast<uint32_t>(G) << 8) | static_cast<uint32_t>(B);
+	}
+	// Same as "ToDecimal" but includes the alpha channel, supported here but may not be standard elsewhere.
+	constexpr uint32_t ToDecimalAlpha() const { return (ToDecimal() << 8) | A; }
+
 	std::string ToHex(bool bNotation = true) const;
 	std::string ToHexAlpha(
 	    bool bNotation = true) const; // Same as "ToHex" but includes the alpha channel, supported here but may not be standard elsewhere.
 	Color &FromLinear(const CoolerLinearColor &linearColor);
-	Color &FromDecimal(uint32_t decimalColor); // Supports both alpha and non alpha channels.
-	Color &FromHex(std::string hexColor);      // Supports both alpha and non alpha channels.
+
+	constexpr Color &FromDecimal(uint32_t decimalColor) { // Supports both alpha and non alpha channels.
+		if (decimalColor > 0xFFFFFF) {
+			R = static_cast<uint8_t>(decimalColor >> 24);
+			G = static_cast<uint8_t>(decimalColor >> 16);
+			B = static_cast<uint8_t>(decimalColor >> 8);
+			A = static_cast<uint8_t>(decimalColor);
+		} else {
+			R = static_cast<uint8_t>(decimalColor >> 16);
+			G = static_cast<uint8_t>(decimalColor >> 8);
+			B = static_cast<uint8_t>(decimalColor);
+			A = 255;
+		}
+		return *this;
+	}
+
+	Color &FromHex(std::string_view hexColor); // Supports both alpha and non alpha channels. Any '#' is ignored, wherever it is
 	Color &Cycle(int32_t steps = 1);
 
 public:
-	Color &operator=(const Color &other);
-	Color &operator=(const struct FColor &other);
-	bool   operator==(const Color &other) const;
-	bool   operator==(const struct FColor &other) const;
-	bool   operator!=(const Color &other) const;
-	bool   operator!=(const struct FColor &other) const;
-	bool   operator<(const Color &other) const;
-	bool   operator>(const Color &other) const;
+	constexpr Color &operator=(const Color &other) = default;
+	constexpr Color &operator=(const struct FColor &other) {
+		R = other.R;
+		G = other.G;
+		B = other.B;
+		A = other.A;
+		return *this;
+	}
+
+	constexpr bool operator==(const Color &other) const { return R == other.R && G == other.G && B == other.B && A == other.A; }
+	constexpr bool operator==(const struct FColor &other) const { return R == other.R && G == other.G && B == other.B && A == other.A; }
+	constexpr bool operator!=(const Color &other) const { return !(*this == other); }
+	constexpr bool operator!=(const struct FColor &other) const { return !(*this == other); }
+	constexpr bool operator<(const Color &other) const { return ToDecimalAlpha() < other.ToDecimalAlpha(); }
+	constexpr bool operator>(const Color &other) const { return ToDecimalAlpha() > other.ToDecimalAlpha(); }
 };
 
 class CoolerLinearColor {
@@ -400,59 +1366,86 @@ public:
 	float R, G, B, A;
 
 public:
-	CoolerLinearColor();
-	explicit CoolerLinearColor(float rgba);
-	explicit CoolerLinearColor(float r, float g, float b, float a);
+	constexpr CoolerLinearColor() : R(1.0f), G(1.0f), B(1.0f), A(1.0f) {}
+	constexpr explicit CoolerLinearColor(float rgba) : R(rgba), G(rgba), B(rgba), A(rgba) {}
+	constexpr explicit CoolerLinearColor(float r, float g, float b, float a) : R(r), G(g), B(b), A(a) {}
 	explicit CoolerLinearColor(uint8_t r, uint8_t g, uint8_t b, uint8_t a); // Auto converts byte color values to floats.
 	CoolerLinearColor(const std::string &hexColor);
-	CoolerLinearColor(const struct FLinearColor &linearColor);
-	CoolerLinearColor(const CoolerLinearColor &linearColor);
-	~CoolerLinearColor();
+	constexpr CoolerLinearColor(const struct FLinearColor &linearColor)
+	    : R(linearColor.R), G(linearColor.G), B(linearColor.B), A(linearColor.A) {}
+	constexpr CoolerLinearColor(const CoolerLinearColor &linearColor) = default;
+	constexpr ~CoolerLinearColor()                                    = default;
 
 public:
 	struct FLinearColor UnrealColor() const;
-	Color               ToColor() const;
-	uint32_t            ToDecimal() const;
-	uint32_t
-	ToDecimalAlpha() const; // Same as "ToDecimal" but includes the alpha channel, supported here but may not be standard elsewhere.
+
+	// Same truncating float --> byte conversion as Color::FromLinear
+	constexpr Color ToColor() const {
+		return Color(static_cast<uint8_t>(R * 255.0f),
+		    static_cast<uint8_t>(G * 255.0f),
+		    static_cast<uint8_t>(B * 255.0f),
+		    static_cast<uint8_t>(A * 255.0f));
+	}
+	constexpr uint32_t ToDecimal() const { return ToColor().ToDecimal(); }
+	// Same as "ToDecimal" but includes the alpha channel, supported here but may not be standard elsewhere.
+	constexpr uint32_t ToDecimalAlpha() const { return ToColor().ToDecimalAlpha(); }
+
 	std::string ToHex(bool bNotation = true) const;
 	std::string ToHexAlpha(
 	    bool bNotation = true) const; // Same as "ToHex" but includes the alpha channel, supported here but may not be standard elsewhere.
 	CoolerLinearColor &FromColor(const Color &color);
 	CoolerLinearColor &FromDecimal(uint32_t decimalColor); // Supports both alpha and non alpha channels.
-	CoolerLinearColor &FromHex(std::string hexColor);      // Supports both alpha and non alpha channels.
+	CoolerLinearColor &FromHex(std::string_view hexColor); // Supports both alpha and non alpha channels. Any '#' is ignored
 	CoolerLinearColor &Cycle(int32_t steps = 1);
 
 public:
-	CoolerLinearColor &operator=(const CoolerLinearColor &other);
-	CoolerLinearColor &operator=(const struct FLinearColor &other);
-	bool               operator==(const CoolerLinearColor &other) const;
-	bool               operator==(const struct FLinearColor &other) const;
-	bool               operator!=(const CoolerLinearColor &other) const;
-	bool               operator!=(const struct FLinearColor &other) const;
-	bool               operator<(const CoolerLinearColor &other) const;
-	bool               operator>(const CoolerLinearColor &other) const;
+	constexpr CoolerLinearColor &operator=(const CoolerLinearColor &other) = default;
+	constexpr CoolerLinearColor &operator=(const struct FLinearColor &other) {
+		R = other.R;
+		G = other.G;
+		B = other.B;
+		A = other.A;
+		return *this;
+	}
+
+	constexpr bool operator==(const CoolerLinearColor &other) const { return R == other.R && G == other.G && B == other.B && A == other.A; }
+	constexpr bool operator==(const struct FLinearColor &other) const {
+		return R == other.R && G == other.G && B == other.B && A == other.A;
+	}
+	constexpr bool operator!=(const CoolerLinearColor &other) const { return !(*this == other); }
+	constexpr bool operator!=(const struct FLinearColor &other) const { return !(*this == other); }
+	constexpr bool operator<(const CoolerLinearColor &other) const { return ToDecimalAlpha() < other.ToDecimalAlpha(); }
+	constexpr bool operator>(const CoolerLinearColor &other) const { return ToDecimalAlpha() > other.ToDecimalAlpha(); }
 };
 
 namespace std {
+	// Both hash the packed 0xRRGGBBAA value (a linear color hashes as the byte color it converts to, same as before)
 	template <>
 	struct hash<Color> {
-		size_t operator()(const Color &other) const { return hash<string>()(other.ToHexAlpha(false)); }
+		size_t operator()(const Color &other) const noexcept {
+			uint64_t x = other.ToDecimalAlpha();
+			x ^= x >> 33;
+			x *= 0xFF51AFD7ED558CCDull; // murmur3 finalizer, spreads the bits across the whole word
+			x ^= x >> 33;
+			return static_cast<size_t>(x);
+		}
 	};
 
 	template <>
 	struct hash<CoolerLinearColor> {
-		size_t operator()(const CoolerLinearColor &other) const { return hash<string>()(other.ToHexAlpha(false)); }
+		size_t operator()(const CoolerLinearColor &other) const noexcept { return hash<Color>()(other.ToColor()); }
 	};
 } // namespace std
 
 // This is a global rainbow color class, hook your own function to the "Tick" function for it to update.
 // This means you can sync up multiple objects to cycle through RGB at the same rate.
+// The getters are lock-free, so they can be read from any thread while the game thread ticks.
 class GRainbowColor {
 private:
-	static inline Color             ByteRainbow   = Color(0, 0, 255, 255);
-	static inline CoolerLinearColor LinearRainbow = CoolerLinearColor(0.0f, 0.0f, 1.0f, 1.0f);
-	static inline uint32_t          tickCounter   = 0; // custom shit
+	static inline std::atomic<uint64_t> position    = 0; // Color::Cycle steps taken since Reset, see RainbowGenerator::hueAt
+	static inline std::atomic<uint32_t> tickCounter = 0; // custom shit
+
+	static void Advance(uint64_t steps);
 
 public:
 	static Color             GetByte();
@@ -466,6 +1459,55 @@ public:
 	static void              TickRGB(int speed, int defaultSpeed); // custom shit
 };
 
+// Time-based rainbow. Each channel's color is a pure function of elapsed time, speed and phase, looked up in O(1) from a hue
+// table that follows the same path as Color::Cycle (blue -> magenta -> red -> yellow -> green -> cyan -> blue).
+// Call Update() from one thread (i.e. every tick), Snapshot() is lock-free and safe to call from any thread.
+//
+// USAGE:
+//     RainbowGenerator rainbow;
+//     auto slow = rainbow.AddChannel(0.1);        // one full cycle every 10 seconds
+//     auto fast = rainbow.AddChannel(0.5, 0.25);  // starts a quarter of the way through the cycle
+//     rainbow.Update(secondsSinceStart);
+//     Color color = rainbow.Snapshot(*slow);
+class RainbowGenerator {
+public:
+	static constexpr uint32_t hueSteps    = 6 * 255; // Color::Cycle steps in a full cycle
+	static constexpr size_t   maxChannels = 64;
+	using ChannelId                       = uint32_t;
+
+private:
+	struct Channel {
+		std::atomic<double>   cyclesPerSecond = 0.0;
+		std::atomic<double>   phase           = 0.0; // in cycles
+		std::atomic<Color>    color           = Color(); // result of the last Update, 4 bytes so always lock-free
+	};
+
+	std::array<Channel, maxChannels> m_channels;
+	std::atomic<uint32_t>            m_channelCount = 0;
+	std::atomic<double>              m_elapsed      = 0.0;
+
+public:
+	static Color hueAt(uint64_t step);   // step-th color of Color::Cycle starting at pure blue, wraps around
+	static Color hueAt(double cycles);   // fraction of a full cycle, wraps around (negative values run backwards)
+	static Color Evaluate(double cyclesPerSecond, double phase, double elapsedSeconds);
+
+	// Converts the GRainbowColor::TickRGB speed settings into a cycle rate for a given tick rate
+	static double CyclesPerSecondFromTickSpeed(int speed, int defaultSpeed, double ticksPerSecond);
+
+	// Returns std::nullopt once maxChannels is reached. Channels are never removed, so ids stay valid
+	std::optional<ChannelId> AddChannel(double cyclesPerSecond, double phase = 0.0);
+	size_t                   ChannelCount() const { return m_channelCount.load(std::memory_order_acquire); }
+	void                     SetSpeed(ChannelId id, double cyclesPerSecond);
+	void                     SetPhase(ChannelId id, double phase);
+
+	void   Update(double elapsedSeconds); // recomputes every channel's snapshot, O(channels)
+	double Elapsed() const { return m_elapsed.load(std::memory_order_relaxed); }
+
+	Color             Snapshot(ChannelId id) const;
+	CoolerLinearColor SnapshotLinear(ChannelId id) const;
+	FLinearColor      SnapshotFLinear(ChannelId id) const;
+};
+
 // Inline helper functions for different color type conversions.
 namespace Colors {
 	uint32_t              packColor(const FColor &col);
@@ -473,6 +1515,20 @@ namespace Colors {
 	std::string           fcolorToHex(const FColor &col);
 	std::optional<FColor> hexToFColor(const std::string &hex);
 
+	// Hex color layouts found in configs and cvars. Digits are case-insensitive, nothing else is allowed around them
+	enum class HexFormat : uint8_t {
+		RGB,          // #RRGGBB, '#' optional, alpha is 255
+		RGBA,         // #RRGGBBAA, '#' optional
+		PrefixedRGBA, // 0xRRGGBBAA, as written by fcolorToHexRGBA
+		ARGB          // AARRGGBB, as written by fcolorToHex
+	};
+
+	// No allocations or exceptions, returns std::nullopt if the string doesn't match the format exactly
+	std::optional<Color> parseHex(std::string_view hex, HexFormat format) noexcept;
+
+	// Parses count strings into dst, writing fallback for the ones that don't match. Returns how many parsed successfully
+	size_t parseHexBatch(const std::string_view *src, Color *dst, size_t count, HexFormat format, Color fallback = Color()) noexcept;
+
 	inline std::string logColor(const FLinearColor &col) { return std::format("R:{}-G:{}-B:{}-A:{}", col.R, col.G, col.B, col.A); }
 	inline std::string logColor(const FColor &col) { return std::format("R:{}-G:{}-B:{}-A:{}", col.R, col.G, col.B, col.A); }
 
@@ -510,17 +1566,186 @@ namespace Colors {
 		return fCol;
 	}
 
+	// Options for the batch conversions below. The defaults match toByte/toFColor (clamped, rounded to nearest)
+	struct BatchOptions {
+		enum class Rounding : uint8_t {
+			Nearest,
+			Truncate // matches fLinearColorToFColor and Color::FromLinear
+		};
+
+		// clamp to [0, 1] before quantizing (NaN becomes 0). When off, values are rounded/truncated to an integer which then wraps
+		// modulo 256, like a static_cast<uint8_t> of that integer. NaN and infinities give 0
+		bool     clamp    = true;
+		Rounding rounding = Rounding::Nearest;
+		bool     sRGB     = false; // bytes are sRGB encoded (LUT based, always rounds to nearest). Alpha is never transformed
+		bool premultipliedAlpha = false; // float --> byte multiplies RGB by alpha, byte --> float divides it back out (0 if alpha is 0)
+	};
+
+	// Batch conversions between float and 8-bit colors, 4 pixels per SSE2 step. The sRGB path is scalar LUT lookups
+	void linearToFColors(const FLinearColor *src, FColor *dst, size_t count, const BatchOptions &opts = {});
+	void linearToRGBA8(const FLinearColor *src, uint8_t *dst, size_t count, const BatchOptions &opts = {}); // dst holds count * 4 bytes
+	void linearToColors(const CoolerLinearColor *src, Color *dst, size_t count, const BatchOptions &opts = {});
+	void fColorsToLinear(const FColor *src, FLinearColor *dst, size_t count, const BatchOptions &opts = {});
+	void rgba8ToLinear(const uint8_t *src, FLinearColor *dst, size_t count, const BatchOptions &opts = {});
+	void colorsToLinear(const Color *src, CoolerLinearColor *dst, size_t count, const BatchOptions &opts = {});
+
+	// General channel permutation for 8-bit pixels with 3 or 4 channels. dstOrder[i] is the source channel written to destination
+	// channel i, or swizzleFill to write fillValue instead (e.g. adding an opaque alpha channel)
+	constexpr uint8_t swizzleFill = 0xFF;
+
+	struct SwizzleSpec {
+		uint8_t                srcChannels = 4;
+		uint8_t                dstChannels = 4;
+		std::array<uint8_t, 4> dstOrder    = {0, 1, 2, 3};
+		uint8_t                fillValue   = 255;
+	};
+
+	// Compile-time checked spec. Usage: makeSwizzle<3, 2, 1, 0, swizzleFill>() --> RGB to BGRA with opaque alpha
+	template <uint8_t srcChannels, uint8_t... dstOrder>
+	constexpr SwizzleSpec makeSwizzle(uint8_t fillValue = 255) {
+		static_assert(srcChannels == 3 || srcChannels == 4, "Only 3 or 4 source channels are supported");
+		static_assert(sizeof...(dstOrder) == 3 || sizeof...(dstOrder) == 4, "Only 3 or 4 destination channels are supported");
+		static_assert(((dstOrder < srcChannels || dstOrder == swizzleFill) && ...), "Channel index out of range");
+
+		SwizzleSpec spec{srcChannels, static_cast<uint8_t>(sizeof...(dstOrder)), {}, fillValue};
+		size_t      i = 0;
+		((spec.dstOrder[i++] = dstOrder), ...);
+		return spec;
+	}
+
+	constexpr SwizzleSpec rgbaToBgra = makeSwizzle<4, 2, 1, 0, 3>();
+	constexpr SwizzleSpec rgbToRgba  = makeSwizzle<3, 0, 1, 2, swizzleFill>();
+	constexpr SwizzleSpec rgbaToRgb  = makeSwizzle<4, 0, 1, 2>();
+
+	// Uses pshufb (AVX2 for 4 --> 4 channels) when the build targets it, otherwise SSE2 shifts for 4 --> 4 and scalar for the rest.
+	// src and dst may only be the same buffer when srcChannels == dstChannels
+	void swizzle(const uint8_t *src, uint8_t *dst, size_t numPixels, const SwizzleSpec &spec);
+
+	// Same as swizzle, but large buffers are split into tiles that are spread across threads (numThreads = 0 --> all cores)
+	void swizzleParallel(const uint8_t *src, uint8_t *dst, size_t numPixels, const SwizzleSpec &spec, size_t numThreads = 0);
+
 	// Swizzle pixel data (i.e. RGBA -> BGRA) <numChannels, channelA, channelB> ... requires 8-bit channels
 	template <uint8_t numChannels, uint8_t channelA, uint8_t channelB>
 	void swizzleChannels(uint8_t *pixelData, size_t numPixels) {
-		for (size_t i = 0; i < numPixels; ++i) {
-			uint8_t *pixel = &pixelData[i * numChannels];
-			std::swap(pixel[channelA], pixel[channelB]);
+		if constexpr (numChannels == 3 || numChannels == 4) {
+			static constexpr SwizzleSpec spec = [] {
+				SwizzleSpec s{numChannels, numChannels, {0, 1, 2, 3}};
+				std::swap(s.dstOrder[channelA], s.dstOrder[channelB]);
+				return s;
+			}();
+			swizzle(pixelData, pixelData, numPixels, spec);
+		} else {
+			for (size_t i = 0; i < numPixels; ++i) {
+				uint8_t *pixel = &pixelData[i * numChannels];
+				std::swap(pixel[channelA], pixel[channelB]);
+			}
 		}
 	}
 
 	inline void rgbaToBGRASwizzle(uint8_t *pixelData, size_t numPixels) { swizzleChannels<4, 0, 2>(pixelData, numPixels); }
 
+	// Chains per-pixel stages over 8-bit RGBA and runs them fused, one cache-sized tile at a time, with tiles spread across threads.
+	// Every stage touches a tile while it's still in L1/L2 instead of streaming the whole image through memory once per stage.
+	// Stages know where each channel ended up after a swizzle, so tint/premultiply always act on the real R, G, B and A.
+	//
+	// USAGE:
+	//     Colors::PixelPipeline pipeline;
+	//     pipeline.Swizzle(Colors::rgbaToBgra).Tint(Color(255, 200, 200, 255)).Premultiply();
+	//     pipeline.Run(pixels, pixels, numPixels);              // in place, RGBA8 --> BGRA8
+	//     pipeline.Run(linearPixels, texture, numPixels);       // FLinearColor --> bytes, then the stages
+	class PixelPipeline {
+	public:
+		static constexpr size_t tilePixels = 4096; // 16 KB of RGBA8 per tile
+
+		using CustomStage = std::function<void(uint8_t *rgba, size_t numPixels)>;
+
+	private:
+		struct Stage {
+			enum class Type : uint8_t {
+				Swizzle,
+				Multiply, // per-position byte multiplier (tint)
+				Premultiply,
+				Custom
+			};
+
+			Type                   type    = Type::Swizzle;
+			SwizzleSpec            swizzle = {};
+			std::array<uint8_t, 4> factors = {}; // Multiply factors, or the alpha position for Premultiply in factors[0]
+			CustomStage            custom  = {};
+		};
+
+		std::vector<Stage>     m_stages;
+		std::array<uint8_t, 4> m_layout     = {0, 1, 2, 3}; // logical channel (R=0, G=1, B=2, A=3) at each position, or swizzleFill
+		BatchOptions           m_conversion = {};
+
+		void RunStages(uint8_t *rgba, size_t numPixels) const;
+
+	public:
+		PixelPipeline &Swizzle(const SwizzleSpec &spec); // 4 --> 4 channels only
+		PixelPipeline &Tint(const Color &tint);          // channel * tint / 255, alpha included
+		PixelPipeline &Premultiply();                    // RGB * A / 255
+		PixelPipeline &Custom(CustomStage stage);        // called once per tile, must only touch the pixels it's given
+		PixelPipeline &Conversion(const BatchOptions &opts);
+
+		bool Empty() const { return m_stages.empty(); }
+		void Clear();
+
+		// numThreads = 0 uses every core, 1 keeps it on the calling thread. src and dst may be the same buffer for RGBA8 --> RGBA8
+		void Run(const uint8_t *src, uint8_t *dst, size_t numPixels, size_t numThreads = 0) const;
+		void Run(const FLinearColor *src, uint8_t *dst, size_t numPixels, size_t numThreads = 0) const; // converts first
+		void Run(const uint8_t *src, FLinearColor *dst, size_t numPixels, size_t numThreads = 0) const; // converts last
+	};
+
+	// Nearest-color lookup against a fixed palette (i.e. the game's paint colors), compared in OKLab by default so "nearest" is what a
+	// player would pick. A 32^3 (or 64^3) grid over RGB stores, per cell, only the palette entries that can be the nearest one for some
+	// color inside that cell. Queries compare against those few instead of the whole palette, and cells with a single candidate
+	// answer without any math at all. Alpha is ignored.
+	enum class PaletteMetric : uint8_t {
+		OKLab, // perceptual, Euclidean distance in OKLab
+		SRGB   // Euclidean distance between the raw 8-bit channels
+	};
+
+	struct PaletteOptions {
+		PaletteMetric        metric   = PaletteMetric::OKLab;
+		std::array<float, 3> weights  = {1.0f, 1.0f, 1.0f}; // per axis (L, a, b or R, G, B), i.e. lower L to care less about brightness
+		uint8_t              gridBits = 5; // 5 --> 32^3 cells (~128 KB), 6 --> 64^3 cells (~1 MB, fewer candidates per cell)
+	};
+
+	class PaletteMatcher {
+	public:
+		static constexpr uint32_t npos = UINT32_MAX;
+
+	private:
+		using Point = std::array<float, 3>;
+
+		std::vector<Color>    m_palette;
+		std::vector<Point>    m_points;      // palette in the weighted metric space
+		std::vector<uint32_t> m_cellOffsets; // candidates of cell i are m_candidates[m_cellOffsets[i], m_cellOffsets[i + 1])
+		std::vector<uint16_t> m_candidates;
+		PaletteOptions        m_options;
+
+		Point    ToPoint(const Color &color) const;
+		uint32_t NearestOf(const Point &point, const uint16_t *candidates, size_t count) const;
+
+	public:
+		PaletteMatcher() = default;
+		explicit PaletteMatcher(std::vector<Color> palette, const PaletteOptions &options = {});
+
+		// Precomputes the grid, spread across all cores. Palettes are limited to 65535 entries
+		void Build(std::vector<Color> palette, const PaletteOptions &options = {});
+
+		const std::vector<Color> &Palette() const { return m_palette; }
+		const PaletteOptions     &GetOptions() const { return m_options; }
+
+		uint32_t Nearest(const Color &color) const; // index into Palette(), npos if it's empty
+		uint32_t Nearest(const CoolerLinearColor &color) const { return Nearest(color.ToColor()); }
+		uint32_t NearestBruteForce(const Color &color) const; // same answer the slow way, for validating custom options
+		void     NearestBatch(const Color *src, uint32_t *dst, size_t count) const;
+		float    Distance(const Color &a, const Color &b) const; // in the configured metric
+
+		static std::array<float, 3> ToOKLab(const Color &color); // L, a, b from an sRGB encoded color
+	};
+
 	// Color to Decimal/Base10
 	inline uint32_t HexToDecimal(std::string hexStr) { return Color(hexStr).ToDecimal(); }
 	inline uint32_t ColorToDecimal(const Color &color) { return color.ToDecimal(); }
@@ -544,4 +1769,95 @@ namespace Colors {
 	inline CoolerLinearColor ColorToLinear(const Color &color) { return color.ToLinear(); }
 } // namespace Colors
 
+// Tweens for per-tick color/value interpolation, so plugins don't each need their own stepping loops.
+// Tracks are stored as structure-of-arrays (up to 4 float lanes each) and a single Tick() advances every track at once, the final
+// interpolation being one branch-free loop over contiguous floats. Handles stay valid until the track is removed, removal of other
+// tracks never invalidates them. Not thread safe, Tick() and the getters are meant for the game thread.
+//
+// USAGE:
+//     Animation::Tweener tweener;
+//     auto fade = tweener.Add(CoolerLinearColor(1.0f, 0.0f, 0.0f, 1.0f), CoolerLinearColor(0.0f, 0.0f, 1.0f, 1.0f), 2.0f,
+//                             Animation::Ease::InOutSine, Animation::Loop::PingPong);
+//     tweener.Tick(deltaSeconds);          // once per tick
+//     Color color = tweener.GetColor(fade).ToColor();
+namespace Animation {
+	enum class Ease : uint8_t {
+		Linear,
+		InQuad,
+		OutQuad,
+		InOutQuad,
+		InCubic,
+		OutCubic,
+		InOutCubic,
+		InOutSine,
+		Step // jumps to the end value once the duration is up
+	};
+
+	enum class Loop : uint8_t {
+		Once,    // stops on the end value
+		Repeat,  // jumps back to the start value
+		PingPong // plays forwards then backwards
+	};
+
+	float applyEase(Ease ease, float t); // t in [0, 1]
+
+	struct TweenHandle {
+		uint32_t slot       = UINT32_MAX;
+		uint32_t generation = 0;
+
+		bool IsSet() const { return slot != UINT32_MAX; }
+	};
+
+	class Tweener {
+		struct Slot {
+			uint32_t dense      = 0; // index into the track arrays
+			uint32_t generation = 0; // bumped on removal so stale handles stop resolving
+		};
+
+		// track arrays, all indexed by the same dense index
+		std::array<std::vector<float>, 4> m_from;
+		std::array<std::vector<float>, 4> m_to;
+		std::array<std::vector<float>, 4> m_value;
+		std::vector<float>                m_elapsed;
+		std::vector<float>                m_duration;
+		std::vector<float>                m_eased; // scratch, eased progress of the current tick
+		std::vector<Ease>                 m_ease;
+		std::vector<Loop>                 m_loop;
+		std::vector<uint32_t>             m_denseToSlot;
+
+		std::vector<Slot>     m_slots;
+		std::vector<uint32_t> m_freeSlots;
+
+		TweenHandle           Add(const float *from, const float *to, size_t lanes, float duration, Ease ease, Loop loop);
+		std::optional<size_t> Resolve(TweenHandle handle) const;
+		void                  Retarget(TweenHandle handle, const float *to, size_t lanes);
+
+	public:
+		TweenHandle Add(float from, float to, float duration, Ease ease = Ease::Linear, Loop loop = Loop::Once);
+		TweenHandle Add(const FVector &from, const FVector &to, float duration, Ease ease = Ease::Linear, Loop loop = Loop::Once);
+		TweenHandle Add(
+		    const CoolerLinearColor &from, const CoolerLinearColor &to, float duration, Ease ease = Ease::Linear, Loop loop = Loop::Once);
+
+		bool   Remove(TweenHandle handle);
+		bool   Contains(TweenHandle handle) const { return Resolve(handle).has_value(); }
+		size_t Size() const { return m_elapsed.size(); }
+		void   Clear();
+
+		void Tick(float deltaSeconds);
+
+		// Restarts from the track's current value towards a new end value, keeping its duration, easing and loop mode
+		void Retarget(TweenHandle handle, float to) { Retarget(handle, &to, 1); }
+		void Retarget(TweenHandle handle, const FVector &to);
+		void Retarget(TweenHandle handle, const CoolerLinearColor &to);
+		void Restart(TweenHandle handle);
+
+		bool Finished(TweenHandle handle) const; // only Loop::Once tracks ever finish, removed tracks count as finished
+
+		// Unknown handles read as zero. A vector track read as a color gets A = 0, and so on
+		float             GetFloat(TweenHandle handle) const;
+		FVector           GetVector(TweenHandle handle) const;
+		CoolerLinearColor GetColor(TweenHandle handle) const;
+	};
+} // namespace Animation
+
 #endif // NO_RLSDK